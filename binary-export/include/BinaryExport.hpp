@@ -26,11 +26,19 @@
  */
 #pragma once
 
+#include "Endianness.hpp"
+
 #include "structure/Visitor.hpp"
+#include "structure/Exception.hpp"
+#include "structure/Layout.hpp"
+#include "structure/type/Structure.hpp"
+#include "structure/value/BlockValue.hpp"
+#include "structure/value/StructureValue.hpp"
 
 #include <vector>
 #include <iterator>
 #include <algorithm>
+#include <cstring>
 
 #ifdef _MSC_VER
 /** Visual studio raises a warning if the check iterator feature is activated
@@ -48,19 +56,17 @@
 
 namespace binary_export
 {
-/** @example binary-export.cpp
- * This show how to use the binary export.
- */
-/** A visitor for binary export.
+namespace detail
+{
+/** Implements binary export on top of a way to output bytes
  *
- * Builtin C types are memcopied to the output. std::strings are exported as C strings. Everything
- * is packed.
+ * @tparam Derived Must implement `void writeBytes(const unsigned char *bytes, size_t size)`
  */
-class Visitor : public structure::StorageVisitor
+template <class Derived>
+class Writer : public structure::StorageVisitor
 {
 public:
-    using Output = std::vector<unsigned char>;
-    Visitor(Output &out) : mOut(out) {}
+    explicit Writer(Endianness endianness) : mSwap(needsSwap(endianness)) {}
 
     void visitStorage(unsigned char v) override { visitStorageT(v); }
     void visitStorage(signed char v) override { visitStorageT(v); }
@@ -79,24 +85,292 @@ public:
 
     void visitStorage(const std::string &v) override
     {
-        std::copy_n(v.c_str(), v.size() + 1, std::back_inserter(mOut));
+        write(reinterpret_cast<const unsigned char *>(v.c_str()), v.size() + 1);
+    }
+    void visitStorage(const char *chars, size_t size) override
+    {
+        static const unsigned char terminator = '\0';
+        write(reinterpret_cast<const unsigned char *>(chars), size);
+        write(&terminator, 1);
+    }
+
+    using structure::StorageVisitor::visitStorage;
+
+    /** Writes zeros until the number of written bytes is a multiple of `alignment` */
+    void pad(size_t alignment)
+    {
+        writeZeros(structure::Layout::align(mWritten, alignment) - mWritten);
+    }
+
+    /** Writes the `length` characters of a string with the given encoding
+     *
+     * @param[in] name The name of the field, for error messages
+     * @throws structure::ValueStructureMismatch if the string can't be represented
+     */
+    void writeString(const char *chars, size_t length,
+                     const structure::attributes::StringEncoding &encoding, const std::string &name)
+    {
+        using Kind = structure::attributes::StringEncoding::Kind;
+        auto bytes = reinterpret_cast<const unsigned char *>(chars);
+        auto tooLong = [&] { return structure::ValueStructureMismatch(name, "String too long"); };
+
+        switch (encoding.mKind) {
+        case Kind::Varint: {
+            unsigned char header[10];
+            size_t size = 0;
+            auto left = static_cast<unsigned long long>(length);
+            do {
+                header[size] = static_cast<unsigned char>(left & 0x7f);
+                left >>= 7;
+                header[size++] |= left != 0 ? 0x80 : 0;
+            } while (left != 0);
+            write(header, size);
+            break;
+        }
+        case Kind::Prefixed:
+            if (encoding.mSize < sizeof(uint64_t) and length >> (8 * encoding.mSize) != 0) {
+                throw tooLong();
+            }
+            switch (encoding.mSize) {
+            case 1:
+                visitStorageT(static_cast<uint8_t>(length));
+                break;
+            case 2:
+                visitStorageT(static_cast<uint16_t>(length));
+                break;
+            case 4:
+                visitStorageT(static_cast<uint32_t>(length));
+                break;
+            default:
+                visitStorageT(static_cast<uint64_t>(length));
+            }
+            break;
+        case Kind::FixedCapacity:
+            if (length > encoding.mSize) {
+                throw tooLong();
+            }
+            write(bytes, length);
+            writeZeros(encoding.mSize - length);
+            return;
+        default:
+            visitStorage(chars, length);
+            return;
+        }
+        write(bytes, length);
     }
 
 private:
     template <class Storage>
     void visitStorageT(Storage v)
     {
-        auto type_erased = reinterpret_cast<const Output::value_type *>(&v);
-        auto first = MAKE_ARRAY_ITERATOR(type_erased, sizeof(v));
-        std::copy(first, first + sizeof(v), std::back_inserter(mOut));
+        auto bytes = reinterpret_cast<unsigned char *>(&v);
+        if (mSwap) {
+            swapScalars(bytes, sizeof(v), 1);
+        }
+        write(bytes, sizeof(v));
+    }
+
+    void write(const unsigned char *bytes, size_t size)
+    {
+        derived().writeBytes(bytes, size);
+        mWritten += size;
+    }
+
+    void writeZeros(size_t count)
+    {
+        static const unsigned char zeros[64] = {};
+        while (count > 0) {
+            auto chunk = std::min(count, sizeof(zeros));
+            write(zeros, chunk);
+            count -= chunk;
+        }
     }
 
+    Derived &derived() { return *static_cast<Derived *>(this); }
+
+    bool mSwap;
+    size_t mWritten = 0;
+};
+
+/** A visitor for binary export into memory that has already been allocated
+ *
+ * It is used when the size of the export is known in advance (see structure::Layout).
+ */
+class InPlaceVisitor : public Writer<InPlaceVisitor>
+{
+public:
+    explicit InPlaceVisitor(unsigned char *out, Endianness endianness = Endianness::Host)
+        : Writer(endianness), mOut(out)
+    {
+    }
+
+    void writeBytes(const unsigned char *bytes, size_t size)
+    {
+        std::memcpy(mOut, bytes, size);
+        mOut += size;
+    }
+
+private:
+    unsigned char *mOut;
+};
+
+/** Captures a reference to the characters of the string storage of a value */
+class StringCapture : public structure::StorageVisitor
+{
+public:
+    void visitStorage(const std::string &v) override { visitStorage(v.data(), v.size()); }
+    void visitStorage(const char *chars, size_t size) override
+    {
+        mChars = chars;
+        mSize = size;
+    }
+    using structure::StorageVisitor::visitStorage;
+
+    const char *data() const { return mChars; }
+    size_t size() const { return mSize; }
+
+private:
+    const char *mChars = nullptr;
+    size_t mSize = 0;
+};
+
+/** Writes the value of a field, as laid out by `node` */
+template <class Derived>
+void writeField(Writer<Derived> &writer, const structure::Layout::Node &node,
+                const structure::StructureValue &value)
+{
+    if (node.encoding.mKind == structure::attributes::StringEncoding::Kind::NulTerminated) {
+        value.accept(writer);
+        return;
+    }
+    StringCapture string;
+    value.accept(string);
+    writer.writeString(string.data(), string.size(), node.encoding, node.field->getName());
+}
+
+/** Writes a value of `structure` along with the padding required by its layout and its string
+ * encodings
+ *
+ * Offsets are relative to the start of the value.
+ */
+template <class Derived>
+void writeAligned(Writer<Derived> &writer, const structure::Layout &layout,
+                  const structure::Structure &structure, const structure::StructureValue &value)
+{
+    using Kind = structure::Layout::Node::Kind;
+    const auto &node = layout.at(structure);
+
+    writer.pad(node.alignment);
+    if (node.kind == Kind::Field) {
+        writeField(writer, node, value);
+        return;
+    }
+
+    const auto &children = static_cast<const structure::BlockValue &>(value).getFields();
+    switch (node.kind) {
+    case Kind::Block: {
+        auto child = begin(node.children);
+        for (const auto &childValue : children) {
+            writeAligned(writer, layout, **child++, *childValue);
+        }
+        break;
+    }
+    case Kind::PrefixedArray: {
+        // Prefixed array values hold the prefix followed by a block of items
+        writeAligned(writer, layout, *node.prefix, *children.front());
+        const auto &items = static_cast<const structure::BlockValue &>(*children.back());
+        for (const auto &item : items.getFields()) {
+            writeAligned(writer, layout, *node.children[0], *item);
+        }
+        break;
+    }
+    default:
+        for (const auto &item : children) {
+            writeAligned(writer, layout, *node.children[0], *item);
+        }
+    }
+
+    if (node.size != structure::Layout::variable) {
+        writer.pad(node.alignment);
+    }
+}
+
+/** Writes a whole value as laid out by `layout` */
+template <class Derived>
+void writeValue(Writer<Derived> &writer, const structure::Layout &layout,
+                const structure::StructureValue &value)
+{
+    if (layout.getPolicy() == structure::LayoutPolicy::Packed and
+        not layout.hasStringEncodings()) {
+        value.accept(writer);
+    } else {
+        writeAligned(writer, layout, value.getStructure(), value);
+    }
+}
+} // namespace detail
+
+/** @example binary-export.cpp
+ * This show how to use the binary export.
+ */
+/** A visitor for binary export.
+ *
+ * Builtin C types are memcopied to the output, byte-swapped if `endianness` is not the host's.
+ * std::strings are exported as C strings. Everything is packed; see write() for aligned layouts.
+ */
+class Visitor : public detail::Writer<Visitor>
+{
+public:
+    using Output = std::vector<unsigned char>;
+    Visitor(Output &out, Endianness endianness = Endianness::Host) : Writer(endianness), mOut(out)
+    {
+    }
+
+    void writeBytes(const unsigned char *bytes, size_t size)
+    {
+        auto first = MAKE_ARRAY_ITERATOR(bytes, size);
+        std::copy(first, first + size, std::back_inserter(mOut));
+    }
+
+private:
     Output &mOut;
 };
 
-void write(Visitor::Output &out, const structure::StructureValue &value)
+/** Export a value at the end of `out`
+ *
+ * Values of a fixed-size structure (see structure::Layout) are written in place, with a single
+ * allocation.
+ *
+ * @param[out] out The output, to which the value is appended
+ * @param[in] value The value to export
+ * @param[in] policy How to align the value's fields; padding is computed relative to the start of
+ *                   the value, regardless of what `out` already contains.
+ * @param[in] endianness The byte order of the exported scalars; fixed-size values are exported
+ *                       in the host's byte order, then swapped in bulk.
+ */
+inline void write(Visitor::Output &out, const structure::StructureValue &value,
+                  structure::LayoutPolicy policy = structure::LayoutPolicy::Packed,
+                  Endianness endianness = Endianness::Host)
 {
-    Visitor visitor(out);
-    value.accept(visitor);
+    auto layout = value.getStructure().getLayout(policy);
+    auto exportValue = [&](auto &visitor) { detail::writeValue(visitor, *layout, value); };
+
+    if (layout->isFixedSize()) {
+        auto offset = out.size();
+        out.resize(offset + layout->getSize());
+        try {
+            detail::InPlaceVisitor visitor(out.data() + offset);
+            exportValue(visitor);
+            if (detail::needsSwap(endianness)) {
+                detail::swapFields(*layout, layout->getRoot(), out.data() + offset);
+            }
+        } catch (...) {
+            out.resize(offset);
+            throw;
+        }
+        return;
+    }
+
+    Visitor visitor(out, endianness);
+    exportValue(visitor);
 }
 } // namespace binary_export
@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "BinaryExport.hpp"
+
+#include "structure/ValueImporter.hpp"
+#include "structure/Layout.hpp"
+#include "structure/type/Block.hpp"
+#include "structure/type/Structure.hpp"
+#include "structure/type/GenericField.hpp"
+#include "structure/value/Atom.hpp"
+#include "structure/value/BlockValue.hpp"
+#include "structure/Exception.hpp"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace binary_export
+{
+namespace detail
+{
+/** Captures a storage visited by a StorageVisitor into an Atom */
+class AtomCapture : public structure::StorageVisitor
+{
+public:
+    void visitStorage(ull v) override { mAtom = v; }
+    void visitStorage(ll v) override { mAtom = v; }
+    void visitStorage(ld v) override { mAtom = v; }
+    void visitStorage(bool v) override { mAtom = v; }
+    void visitStorage(const std::string &v) override { mAtom = v; }
+    using structure::StorageVisitor::visitStorage;
+
+    const structure::Atom &get() const { return mAtom; }
+
+private:
+    structure::Atom mAtom;
+};
+
+/** Where the characters of an exported string lie */
+struct StringExtent
+{
+    /** From the start of the exported string */
+    size_t offset;
+    size_t length;
+    /** The number of bytes taken by the exported string */
+    size_t size;
+};
+
+/** @returns where the characters of an exported string are, according to the field's encoding
+ *
+ * @param[in] swap Whether length prefixes must be byte-swapped (see Endianness)
+ * @throws structure::ValueStructureMismatch if the string does not fit in the available bytes
+ */
+inline StringExtent stringExtent(const structure::GenericField &field, const unsigned char *data,
+                                 size_t available, bool swap)
+{
+    using Kind = structure::attributes::StringEncoding::Kind;
+    auto encoding = field.getStringEncoding();
+    auto truncated = [&] {
+        return structure::ValueStructureMismatch(field.getName(), "Truncated string");
+    };
+
+    size_t offset = 0;
+    unsigned long long length = 0;
+    switch (encoding.mKind) {
+    case Kind::Varint:
+        for (unsigned shift = 0;; shift += 7) {
+            if (offset == available) {
+                throw truncated();
+            }
+            if (shift >= 64) {
+                throw structure::ValueStructureMismatch(field.getName(), "Invalid string length");
+            }
+            auto byte = data[offset++];
+            length |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        break;
+    case Kind::Prefixed: {
+        offset = encoding.mSize;
+        if (offset > available) {
+            throw truncated();
+        }
+        unsigned char prefix[sizeof(uint64_t)];
+        std::memcpy(prefix, data, offset);
+        if (swap) {
+            swapScalars(prefix, offset, 1);
+        }
+        uint8_t u8;
+        uint16_t u16;
+        uint32_t u32;
+        uint64_t u64;
+        switch (offset) {
+        case 1:
+            std::memcpy(&u8, prefix, offset);
+            length = u8;
+            break;
+        case 2:
+            std::memcpy(&u16, prefix, offset);
+            length = u16;
+            break;
+        case 4:
+            std::memcpy(&u32, prefix, offset);
+            length = u32;
+            break;
+        default:
+            std::memcpy(&u64, prefix, offset);
+            length = u64;
+        }
+        break;
+    }
+    case Kind::FixedCapacity: {
+        if (encoding.mSize > available) {
+            throw truncated();
+        }
+        auto end = static_cast<const unsigned char *>(std::memchr(data, '\0', encoding.mSize));
+        length = end == nullptr ? encoding.mSize : static_cast<size_t>(end - data);
+        return {0, static_cast<size_t>(length), encoding.mSize};
+    }
+    default: {
+        auto end = static_cast<const unsigned char *>(std::memchr(data, '\0', available));
+        if (end == nullptr) {
+            throw structure::ValueStructureMismatch(field.getName(), "Unterminated string");
+        }
+        length = static_cast<size_t>(end - data);
+        return {0, static_cast<size_t>(length), static_cast<size_t>(length) + 1};
+    }
+    }
+
+    if (length > available - offset) {
+        throw truncated();
+    }
+    return {offset, static_cast<size_t>(length), offset + static_cast<size_t>(length)};
+}
+
+/** @returns the characters of an exported string */
+inline std::string readString(const structure::GenericField &field, const unsigned char *data,
+                              size_t available, bool swap)
+{
+    auto extent = stringExtent(field, data, available, swap);
+    return std::string(reinterpret_cast<const char *>(data + extent.offset), extent.length);
+}
+
+/** @returns the number of bytes taken by an exported field
+ *
+ * @param[in] swap Whether length prefixes must be byte-swapped (see Endianness)
+ * @throws structure::ValueStructureMismatch if the field does not fit in the available bytes
+ */
+inline size_t fieldSize(const structure::GenericField &field, const unsigned char *data,
+                        size_t available, bool swap = false)
+{
+    auto size = field.getStorageSize();
+    if (size == 0) {
+        return stringExtent(field, data, available, swap).size;
+    }
+    if (size > available) {
+        throw structure::ValueStructureMismatch(field.getName(), "Truncated field");
+    }
+    return size;
+}
+
+/** Reads an exported field and moves `data` past it
+ *
+ * @param[in] swap Whether the field's bytes must be reversed (see Endianness)
+ * @throws structure::ValueStructureMismatch if the field does not fit before `end`
+ */
+inline structure::Atom readAtom(const structure::GenericField &field, const unsigned char *&data,
+                                const unsigned char *end, bool swap)
+{
+    auto available = static_cast<size_t>(end - data);
+    if (field.getStorageSize() == 0) {
+        auto extent = stringExtent(field, data, available, swap);
+        structure::Atom atom(
+            std::string(reinterpret_cast<const char *>(data + extent.offset), extent.length));
+        data += extent.size;
+        return atom;
+    }
+
+    auto size = fieldSize(field, data, available);
+    AtomCapture capture;
+    if (swap and size > 1) {
+        // Arithmetic storages are never larger than a long double
+        unsigned char swapped[sizeof(long double)];
+        std::memcpy(swapped, data, size);
+        swapScalars(swapped, size, 1);
+        field.visitRawStorage(swapped, capture);
+    } else {
+        field.visitRawStorage(data, capture);
+    }
+    data += size;
+    return capture.get();
+}
+
+/** Imports values exported with an aligned layout policy
+ *
+ * Unlike Importer, it is driven by the layout: it needs to know where padding is, which
+ * ValueImporter does not tell.
+ */
+class AlignedReader
+{
+public:
+    AlignedReader(const structure::Layout &layout, const unsigned char *data, size_t size,
+                  Endianness endianness = Endianness::Host)
+        : mLayout(layout), mBegin(data), mData(data), mEnd(data + size),
+          mSwap(needsSwap(endianness))
+    {
+    }
+
+    std::unique_ptr<structure::StructureValue> read(const structure::Structure &structure)
+    {
+        using Kind = structure::Layout::Node::Kind;
+        const auto &node = mLayout.at(structure);
+
+        skipPadding(structure, node.alignment);
+        if (node.kind == Kind::Field) {
+            return readField(*node.field);
+        }
+
+        const auto &block = static_cast<const structure::Block &>(structure);
+        auto value = std::make_unique<structure::BlockValue>(block);
+        // Blocks may have no children, arrays have exactly one: their item
+        auto item = [&node]() -> const structure::Structure & { return *node.children[0]; };
+        switch (node.kind) {
+        case Kind::Block:
+            for (auto child : node.children) {
+                value->addValue(read(*child));
+            }
+            break;
+        case Kind::Array:
+            for (size_t i = 0; i < node.count; ++i) {
+                value->addValue(read(item()));
+            }
+            break;
+        case Kind::VarArray:
+            // Variable-size values are not tail-padded: the array goes on until the end.
+            while (not atEnd()) {
+                value->addValue(read(item()));
+            }
+            break;
+        default: {
+            skipPadding(*node.prefix, mLayout.at(*node.prefix).alignment);
+            auto count = readAtom(*node.prefix, mData, mEnd, mSwap);
+            value->addValue(node.prefix->withStorage(count));
+            // Prefixed array values hold the prefix followed by a block of items
+            auto items = std::make_unique<structure::BlockValue>(block);
+            for (auto i = count.as<unsigned long long>(); i > 0; --i) {
+                items->addValue(read(item()));
+            }
+            value->addValue(std::move(items));
+        }
+        }
+
+        if (node.size != structure::Layout::variable) {
+            skipPadding(structure, node.alignment);
+        }
+        return std::unique_ptr<structure::StructureValue>(std::move(value));
+    }
+
+    bool atEnd() const { return mData == mEnd; }
+
+private:
+    void skipPadding(const structure::Structure &structure, size_t alignment)
+    {
+        auto offset = structure::Layout::align(static_cast<size_t>(mData - mBegin), alignment);
+        if (offset > static_cast<size_t>(mEnd - mBegin)) {
+            throw structure::ValueStructureMismatch(structure.getName(), "Truncated padding");
+        }
+        mData = mBegin + offset;
+    }
+
+    std::unique_ptr<structure::StructureValue> readField(const structure::GenericField &field)
+    {
+        return field.withStorage(readAtom(field, mData, mEnd, mSwap));
+    }
+
+    const structure::Layout &mLayout;
+    const unsigned char *mBegin;
+    const unsigned char *mData;
+    const unsigned char *mEnd;
+    bool mSwap;
+};
+} // namespace detail
+
+/** Imports values exported by write()
+ *
+ * Example:
+ * @code
+ * binary_export::Importer importer(bytes.data(), bytes.size());
+ * auto value = structure.build(importer);
+ * @endcode
+ */
+class Importer : public structure::ValueImporter
+{
+public:
+    Importer(const unsigned char *data, size_t size, Endianness endianness = Endianness::Host)
+        : mData(data), mEnd(data + size), mSwap(detail::needsSwap(endianness))
+    {
+    }
+
+    std::unique_ptr<structure::GenericFieldValue> import(const structure::GenericField &field,
+                                                         const std::string &path) override
+    {
+        if (atEnd()) {
+            // Allows variable-length arrays to stop at the end of the data
+            throw structure::NotEnoughValues(path);
+        }
+        return field.withStorage(detail::readAtom(field, mData, mEnd, mSwap));
+    }
+
+    bool atEnd() const { return mData == mEnd; }
+    size_t remaining() const { return static_cast<size_t>(mEnd - mData); }
+
+private:
+    const unsigned char *mData;
+    const unsigned char *mEnd;
+    bool mSwap;
+};
+
+/** Imports a value exported by write()
+ *
+ * @param[in] policy The policy the value has been exported with; padding bytes are skipped
+ *                   without being checked.
+ * @param[in] endianness The byte order the value has been exported with; fixed-size values are
+ *                       swapped in bulk into a copy before being read.
+ * @throws structure::ValueStructureMismatch if the data is truncated or has trailing bytes
+ */
+inline std::unique_ptr<structure::StructureValue> read(
+    const structure::Structure &structure, const unsigned char *data, size_t size,
+    structure::LayoutPolicy policy = structure::LayoutPolicy::Packed,
+    Endianness endianness = Endianness::Host)
+{
+    auto layout = structure.getLayout(policy);
+    if (layout->isFixedSize() and layout->getSize() != size) {
+        throw structure::ValueStructureMismatch(structure.getName(), "Wrong size");
+    }
+
+    if (layout->isFixedSize() and detail::needsSwap(endianness)) {
+        std::vector<unsigned char> swapped(data, data + size);
+        detail::swapFields(*layout, layout->getRoot(), swapped.data());
+        return read(structure, swapped.data(), size, policy);
+    }
+
+    if (policy != structure::LayoutPolicy::Packed) {
+        detail::AlignedReader reader(*layout, data, size, endianness);
+        auto value = reader.read(structure);
+        if (not reader.atEnd()) {
+            throw structure::ValueStructureMismatch(structure.getName(), "Trailing bytes");
+        }
+        return value;
+    }
+
+    Importer importer(data, size, endianness);
+    auto value = structure.build(importer);
+    if (not importer.atEnd()) {
+        throw structure::ValueStructureMismatch(structure.getName(), "Trailing bytes");
+    }
+    return value;
+}
+
+/** See read(const structure::Structure &, const unsigned char *, size_t,
+ * structure::LayoutPolicy, Endianness)
+ */
+inline std::unique_ptr<structure::StructureValue> read(
+    const structure::Structure &structure, const Visitor::Output &input,
+    structure::LayoutPolicy policy = structure::LayoutPolicy::Packed,
+    Endianness endianness = Endianness::Host)
+{
+    return read(structure, input.data(), input.size(), policy, endianness);
+}
+} // namespace binary_export
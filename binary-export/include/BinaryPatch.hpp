@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "BinaryExport.hpp"
+
+#include "structure/type/Structure.hpp"
+#include "structure/type/GenericField.hpp"
+#include "structure/Delta.hpp"
+#include "structure/Exception.hpp"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace binary_export
+{
+/** Apply changes to an exported value, in place
+ *
+ * Only the modified fields are written: their offsets are taken from the structure's layout (see
+ * structure::Layout), without browsing the value nor the schema. The structure must have a
+ * fixed size.
+ *
+ * @param[in] structure The structure of the exported value
+ * @param[in,out] data The exported value
+ * @param[in] size The size of the exported value
+ * @param[in] delta The changes, typically computed by structure::diff()
+ * @param[in] policy The policy the value has been exported with
+ * @param[in] endianness The byte order the value has been exported with
+ * @throws structure::ValueStructureMismatch if the structure does not have a fixed size, if the
+ *         data or the delta do not match it.
+ * @throws structure::ParseError or std::range_error if a new storage does not fit in its field.
+ *
+ * Changes are applied all or nothing: the data is left untouched if any of them is rejected.
+ */
+inline void patch(const structure::Structure &structure, unsigned char *data, size_t size,
+                  const structure::Delta &delta,
+                  structure::LayoutPolicy policy = structure::LayoutPolicy::Packed,
+                  Endianness endianness = Endianness::Host)
+{
+    if (structure.getFingerprint() != delta.getFingerprint()) {
+        throw structure::ValueStructureMismatch(structure.getName(),
+                                                "The delta is for another structure");
+    }
+    auto layout = structure.getLayout(policy);
+    if (not layout->isFixedSize()) {
+        throw structure::ValueStructureMismatch(structure.getName(),
+                                                "Only fixed-size values can be patched in place");
+    }
+    if (layout->getSize() != size) {
+        throw structure::ValueStructureMismatch(structure.getName(), "Wrong size");
+    }
+
+    // The fields are encoded one after the other in a staging buffer, then copied in place once
+    // they all have been.
+    std::vector<unsigned char> staging;
+    std::vector<std::pair<size_t, size_t>> offsetsAndSizes;
+    offsetsAndSizes.reserve(delta.getChanges().size());
+    for (const auto &change : delta.getChanges()) {
+        if (change.field >= layout->getRoot().fieldCount) {
+            throw structure::ValueStructureMismatch(structure.getName(),
+                                                    "The delta refers to unexisting fields");
+        }
+        auto location = layout->locate(change.field);
+        const auto &node = layout->at(location.field);
+        auto value = location.field.withStorage(change.after);
+        auto staged = staging.size();
+        staging.resize(staged + node.size);
+        detail::InPlaceVisitor visitor(staging.data() + staged, endianness);
+        detail::writeField(visitor, node, *value);
+        offsetsAndSizes.emplace_back(location.offset, node.size);
+    }
+
+    auto staged = staging.data();
+    for (const auto &offsetAndSize : offsetsAndSizes) {
+        std::memcpy(data + offsetAndSize.first, staged, offsetAndSize.second);
+        staged += offsetAndSize.second;
+    }
+}
+
+/** See patch(const structure::Structure &, unsigned char *, size_t, const structure::Delta &,
+ * structure::LayoutPolicy, Endianness)
+ */
+inline void patch(const structure::Structure &structure, Visitor::Output &data,
+                  const structure::Delta &delta,
+                  structure::LayoutPolicy policy = structure::LayoutPolicy::Packed,
+                  Endianness endianness = Endianness::Host)
+{
+    patch(structure, data.data(), data.size(), delta, policy, endianness);
+}
+} // namespace binary_export
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/Layout.hpp"
+#include "structure/type/GenericField.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace binary_export
+{
+/** The byte order of exported scalars */
+enum class Endianness
+{
+    /** The byte order of the machine performing the export: scalars are copied as they are */
+    Host,
+    Little,
+    Big
+};
+
+namespace detail
+{
+/** @returns whether scalars need to be byte-swapped in order to be exported with `endianness` */
+inline bool needsSwap(Endianness endianness)
+{
+    if (endianness == Endianness::Host) {
+        return false;
+    }
+    const uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, sizeof(first));
+    auto host = first == 1 ? Endianness::Little : Endianness::Big;
+    return endianness != host;
+}
+
+inline uint16_t byteSwap(uint16_t v)
+{
+    return static_cast<uint16_t>((v >> 8) | (v << 8));
+}
+inline uint32_t byteSwap(uint32_t v)
+{
+#if defined(__GNUC__)
+    return __builtin_bswap32(v);
+#else
+    return ((v & 0xff) << 24) | ((v & 0xff00) << 8) | ((v >> 8) & 0xff00) | (v >> 24);
+#endif
+}
+inline uint64_t byteSwap(uint64_t v)
+{
+#if defined(__GNUC__)
+    return __builtin_bswap64(v);
+#else
+    return (uint64_t{byteSwap(static_cast<uint32_t>(v))} << 32) |
+           byteSwap(static_cast<uint32_t>(v >> 32));
+#endif
+}
+
+/** Byte-swaps contiguous, possibly unaligned, words
+ *
+ * The loop is simple enough for compilers to vectorize it.
+ */
+template <class Word>
+void swapWords(unsigned char *data, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        Word word;
+        std::memcpy(&word, data + i * sizeof(word), sizeof(word));
+        word = byteSwap(word);
+        std::memcpy(data + i * sizeof(word), &word, sizeof(word));
+    }
+}
+
+/** Reverses the bytes of each of `count` contiguous scalars of `size` bytes */
+inline void swapScalars(unsigned char *data, size_t size, size_t count)
+{
+    switch (size) {
+    case 1:
+        return;
+    case 2:
+        return swapWords<uint16_t>(data, count);
+    case 4:
+        return swapWords<uint32_t>(data, count);
+    case 8:
+        return swapWords<uint64_t>(data, count);
+    default:
+        // e.g. long double
+        for (size_t i = 0; i < count; ++i) {
+            std::reverse(data + i * size, data + (i + 1) * size);
+        }
+    }
+}
+
+/** Byte-swaps, in place, all the fields of an exported fixed-size value
+ *
+ * Arrays of fields are swapped in bulk.
+ *
+ * @param[in] layout The layout of the value
+ * @param[in] node The layout of the value, or of one of its subtrees
+ * @param[in,out] data Where the value (or the subtree) has been exported
+ */
+inline void swapFields(const structure::Layout &layout, const structure::Layout::Node &node,
+                       unsigned char *data)
+{
+    using Kind = structure::Layout::Node::Kind;
+    switch (node.kind) {
+    case Kind::Field:
+        // Fixed-capacity strings are not scalars
+        if (node.field->getStorageSize() != 0) {
+            swapScalars(data, node.size, 1);
+        }
+        break;
+    case Kind::Array: {
+        const auto &item = layout.at(*node.children[0]);
+        auto stride = structure::Layout::stride(item);
+        if (item.kind == Kind::Field and item.field->getStorageSize() != 0 and
+            stride == item.size) {
+            swapScalars(data, item.size, node.count);
+            break;
+        }
+        for (size_t i = 0; i < node.count; ++i) {
+            swapFields(layout, item, data + i * stride);
+        }
+        break;
+    }
+    default:
+        for (size_t i = 0; i < node.children.size(); ++i) {
+            swapFields(layout, layout.at(*node.children[i]), data + node.offsets[i]);
+        }
+    }
+}
+} // namespace detail
+} // namespace binary_export
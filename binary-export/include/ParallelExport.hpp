@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "BinaryExport.hpp"
+#include "structure/detail/parallel.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace binary_export
+{
+/** A list of values to be exported */
+using Values = std::vector<std::reference_wrapper<const structure::StructureValue>>;
+
+namespace detail
+{
+/** A part of a value, along with its structure in the schema of the whole value
+ *
+ * That structure is not always the one of the value: FieldValues hold a copy of their field and
+ * the items of a prefixed array are held by a block whose structure is the array itself.
+ */
+struct Chunk
+{
+    const structure::Structure *structure;
+    const structure::StructureValue *value;
+};
+
+/** Splits a value like structure::split(), following `layout` rather than the value's structures
+ *
+ * Prefixed arrays are kept whole.
+ */
+inline std::vector<Chunk> split(const structure::Layout &layout,
+                                const structure::StructureValue &value, size_t minChunks)
+{
+    using Kind = structure::Layout::Node::Kind;
+    std::vector<Chunk> chunks{{&value.getStructure(), &value}};
+
+    bool expanded = true;
+    while (expanded and chunks.size() < minChunks) {
+        expanded = false;
+        std::vector<Chunk> next;
+        for (const auto &chunk : chunks) {
+            const auto &node = layout.at(*chunk.structure);
+            if (node.kind == Kind::Field or node.kind == Kind::PrefixedArray) {
+                next.push_back(chunk);
+                continue;
+            }
+            auto child = begin(node.children);
+            const auto &block = static_cast<const structure::BlockValue &>(*chunk.value);
+            for (const auto &field : block.getFields()) {
+                const auto *structure = node.kind == Kind::Block ? *child++ : node.children[0];
+                next.push_back({structure, field.get()});
+            }
+            expanded = true;
+        }
+        chunks = std::move(next);
+    }
+    return chunks;
+}
+
+/** Calls `write(buffer, i)` for each i in [0, count) on at most `jobs` threads, then appends the
+ * buffers to `out` in order
+ */
+template <class Write>
+void writeConcurrently(Visitor::Output &out, size_t count, unsigned jobs, Write write)
+{
+    if (count == 0) {
+        return;
+    }
+    std::vector<Visitor::Output> buffers(std::min<size_t>(std::max(1u, jobs), count));
+
+    structure::detail::parallelFor(count, jobs, [&](size_t job, size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            write(buffers[job], i);
+        }
+    });
+
+    size_t size = out.size();
+    for (const auto &buffer : buffers) {
+        size += buffer.size();
+    }
+    out.reserve(size);
+    for (const auto &buffer : buffers) {
+        out.insert(end(out), begin(buffer), end(buffer));
+    }
+}
+} // namespace detail
+
+/** Export several values concurrently
+ *
+ * The values are dispatched in contiguous groups to at most `jobs` threads, each one exporting to
+ * its own buffer. The buffers are then appended to `out` in order, so that the result is the same
+ * as calling write() on each value in turn.
+ *
+ * @param[out] out The buffer to which the values are appended
+ * @param[in] values The values to be exported, in order
+ * @param[in] jobs The maximum number of threads to be used
+ * @param[in] policy See write(Visitor::Output &, const structure::StructureValue &,
+ *                   structure::LayoutPolicy, Endianness)
+ * @param[in] endianness Idem
+ */
+inline void write(Visitor::Output &out, const Values &values,
+                  unsigned jobs = structure::detail::defaultJobs(),
+                  structure::LayoutPolicy policy = structure::LayoutPolicy::Packed,
+                  Endianness endianness = Endianness::Host)
+{
+    detail::writeConcurrently(out, values.size(), jobs, [&](Visitor::Output &buffer, size_t i) {
+        write(buffer, values[i].get(), policy, endianness);
+    });
+}
+
+/** Export a single value concurrently
+ *
+ * The value is split at its block and array boundaries (see structure::split()) into enough
+ * chunks to keep `jobs` threads busy; the result is the same as the single-threaded write().
+ *
+ * Padding depends on where fields lie relative to the start of the value, which chunks exported
+ * apart can't tell: values are only split with LayoutPolicy::Packed, they are exported by a single
+ * thread otherwise.
+ *
+ * @param[out] out The buffer to which the value is appended
+ * @param[in] value The value to be exported
+ * @param[in] jobs The maximum number of threads to be used
+ * @param[in] policy See write(Visitor::Output &, const structure::StructureValue &,
+ *                   structure::LayoutPolicy, Endianness)
+ * @param[in] endianness Idem
+ */
+inline void write(Visitor::Output &out, const structure::StructureValue &value, unsigned jobs,
+                  structure::LayoutPolicy policy = structure::LayoutPolicy::Packed,
+                  Endianness endianness = Endianness::Host)
+{
+    if (policy != structure::LayoutPolicy::Packed) {
+        write(out, value, policy, endianness);
+        return;
+    }
+
+    // The layout of the whole value lays out every chunk: it is only computed once.
+    auto layout = value.getStructure().getLayout(policy);
+    // Having more chunks than jobs smoothes the load when the chunks have various sizes.
+    const size_t chunksPerJob = 4;
+    auto chunks = detail::split(*layout, value, jobs * chunksPerJob);
+
+    detail::writeConcurrently(out, chunks.size(), jobs, [&](Visitor::Output &buffer, size_t i) {
+        Visitor visitor(buffer, endianness);
+        const auto &chunk = chunks[i];
+        if (layout->hasStringEncodings()) {
+            detail::writeAligned(visitor, *layout, *chunk.structure, *chunk.value);
+        } else {
+            chunk.value->accept(visitor);
+        }
+    });
+}
+} // namespace binary_export
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "BinaryExport.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <system_error>
+#include <sys/uio.h>
+#include <unistd.h>
+#define BINARY_EXPORT_HAS_FD 1
+#endif
+
+namespace binary_export
+{
+namespace detail
+{
+/** A contiguous range of bytes to be output */
+struct Region
+{
+    const unsigned char *data;
+    size_t size;
+};
+
+/** Where StreamVisitor outputs its bytes */
+class Sink
+{
+public:
+    virtual ~Sink() = default;
+
+    /** Outputs the regions, in order
+     *
+     * @throws std::runtime_error (or a derived class) if the output fails
+     */
+    virtual void write(const Region *regions, size_t count) = 0;
+};
+
+class OstreamSink : public Sink
+{
+public:
+    explicit OstreamSink(std::ostream &out) : mOut(out) {}
+
+    void write(const Region *regions, size_t count) override
+    {
+        for (size_t i = 0; i < count; ++i) {
+            mOut.write(reinterpret_cast<const char *>(regions[i].data),
+                       static_cast<std::streamsize>(regions[i].size));
+        }
+        if (not mOut) {
+            throw std::runtime_error("Binary export: could not write to the stream");
+        }
+    }
+
+private:
+    std::ostream &mOut;
+};
+
+#ifdef BINARY_EXPORT_HAS_FD
+/** Writes to a file descriptor, gathering the regions with writev() */
+class FdSink : public Sink
+{
+public:
+    explicit FdSink(int fd) : mFd(fd) {}
+
+    void write(const Region *regions, size_t count) override
+    {
+        std::vector<iovec> vectors;
+        vectors.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (regions[i].size != 0) {
+                vectors.push_back({const_cast<unsigned char *>(regions[i].data), regions[i].size});
+            }
+        }
+
+        auto pending = vectors.data();
+        auto left = vectors.size();
+        while (left > 0) {
+            auto written = ::writev(mFd, pending, static_cast<int>(left));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "Binary export: writev");
+            }
+            // Skip what has been written, which may end in the middle of a region
+            auto done = static_cast<size_t>(written);
+            while (left > 0 and done >= pending->iov_len) {
+                done -= pending->iov_len;
+                ++pending;
+                --left;
+            }
+            if (left > 0) {
+                pending->iov_base = static_cast<unsigned char *>(pending->iov_base) + done;
+                pending->iov_len -= done;
+            }
+        }
+    }
+
+private:
+    int mFd;
+};
+#endif
+} // namespace detail
+
+/** A visitor for binary export to a std::ostream or a file descriptor
+ *
+ * The output is the same as Visitor's but, instead of growing a buffer as large as the exported
+ * values, bytes go through a buffer of bounded size which is flushed whenever it is full. Regions
+ * which are at least half as large as the buffer (e.g. long strings) are not copied: they are
+ * output directly, along with the buffered bytes (in a single writev() for file descriptors).
+ *
+ * The destructor does not flush the buffer since it would have no way to report errors: call
+ * flush() once done.
+ */
+class StreamVisitor : public detail::Writer<StreamVisitor>
+{
+public:
+    static constexpr size_t defaultBufferSize = 64 * 1024;
+
+    explicit StreamVisitor(std::ostream &out, Endianness endianness = Endianness::Host,
+                           size_t bufferSize = defaultBufferSize)
+        : StreamVisitor(std::make_unique<detail::OstreamSink>(out), endianness, bufferSize)
+    {
+    }
+#ifdef BINARY_EXPORT_HAS_FD
+    explicit StreamVisitor(int fd, Endianness endianness = Endianness::Host,
+                           size_t bufferSize = defaultBufferSize)
+        : StreamVisitor(std::make_unique<detail::FdSink>(fd), endianness, bufferSize)
+    {
+    }
+#endif
+
+    void writeBytes(const unsigned char *bytes, size_t size)
+    {
+        if (size >= mCapacity / 2) {
+            detail::Region regions[] = {{mBuffer.data(), mBuffer.size()}, {bytes, size}};
+            mSink->write(regions, 2);
+            mBuffer.clear();
+            return;
+        }
+        if (mBuffer.size() + size > mCapacity) {
+            flush();
+        }
+        mBuffer.insert(end(mBuffer), bytes, bytes + size);
+    }
+
+    /** Outputs the buffered bytes */
+    void flush()
+    {
+        if (not mBuffer.empty()) {
+            detail::Region region{mBuffer.data(), mBuffer.size()};
+            mSink->write(&region, 1);
+            mBuffer.clear();
+        }
+    }
+
+private:
+    StreamVisitor(std::unique_ptr<detail::Sink> sink, Endianness endianness, size_t bufferSize)
+        : Writer(endianness), mSink(std::move(sink)), mCapacity(std::max<size_t>(1, bufferSize))
+    {
+        mBuffer.reserve(mCapacity);
+    }
+
+    std::unique_ptr<detail::Sink> mSink;
+    size_t mCapacity;
+    std::vector<unsigned char> mBuffer;
+};
+
+/** Export a value to a stream, through a buffer of bounded size
+ *
+ * The result is the same as write(Visitor::Output &, const structure::StructureValue &,
+ * structure::LayoutPolicy, Endianness).
+ */
+inline void write(std::ostream &out, const structure::StructureValue &value,
+                  structure::LayoutPolicy policy = structure::LayoutPolicy::Packed,
+                  Endianness endianness = Endianness::Host)
+{
+    StreamVisitor visitor(out, endianness);
+    detail::writeValue(visitor, *value.getStructure().getLayout(policy), value);
+    visitor.flush();
+}
+
+#ifdef BINARY_EXPORT_HAS_FD
+/** Export a value to a file descriptor, through a buffer of bounded size
+ *
+ * @throws std::system_error if writing fails
+ * @see write(std::ostream &, const structure::StructureValue &, structure::LayoutPolicy,
+ *      Endianness)
+ */
+inline void write(int fd, const structure::StructureValue &value,
+                  structure::LayoutPolicy policy = structure::LayoutPolicy::Packed,
+                  Endianness endianness = Endianness::Host)
+{
+    StreamVisitor visitor(fd, endianness);
+    detail::writeValue(visitor, *value.getStructure().getLayout(policy), value);
+    visitor.flush();
+}
+#endif
+} // namespace binary_export
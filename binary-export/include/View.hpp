@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "BinaryImport.hpp"
+
+#include "structure/type/stock.hpp"
+#include "structure/value/StructureValue.hpp"
+#include "structure/Visitor.hpp"
+#include "structure/Exception.hpp"
+#include "structure/detail/convert.hpp"
+
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace binary_export
+{
+/** A read-only view of a value exported by write(), directly over the exported bytes
+ *
+ * Fields are read on demand: nothing is copied nor allocated except for the returned values, which
+ * makes views suitable for reading a few fields out of large blobs (e.g. memory-mapped files).
+ * Offsets are computed from the schema's layout (see structure::Layout): fixed-size blocks and
+ * arrays are jumped over instead of being browsed.
+ *
+ * Views mirror values, except for prefixed arrays: their fields are the prefix then the items. As
+ * in the exported bytes, a variable-length array is assumed to span until the end of the data: it
+ * must be the last field of the value.
+ *
+ * Example:
+ * @code
+ * binary_export::View calibration(schema, mapped, mappedSize);
+ * auto gain = calibration.get<float>("channels/3/gain");
+ * @endcode
+ *
+ * The bytes must outlive the view and all the views obtained from it.
+ */
+class View
+{
+public:
+    /**
+     * @param[in] structure The structure of the exported value
+     * @param[in] data The exported value
+     * @param[in] size The number of available bytes
+     * @throws structure::ValueStructureMismatch if the value does not fit in the available bytes
+     */
+    View(const structure::Structure &structure, const unsigned char *data, size_t size)
+        : View(structure.getLayout(), structure, data, size)
+    {
+    }
+    /** See View(const structure::Structure &, const unsigned char *, size_t) */
+    View(const structure::Structure &structure, const Visitor::Output &data)
+        : View(structure, data.data(), data.size())
+    {
+    }
+
+    const structure::Structure &getStructure() const { return mStructure; }
+    const std::string &getName() const { return mStructure.getName(); }
+    /** @returns the first byte of the value */
+    const unsigned char *data() const { return mData; }
+    /** @returns the number of bytes taken by the value */
+    size_t size() const { return mSize; }
+
+    /** @returns a view of each child of a block or array
+     *
+     * @throws structure::NotABlock if the view is that of a field
+     */
+    std::vector<View> getFields() const
+    {
+        std::vector<View> result;
+        forEachChild(
+            [&](const View &child) {
+                result.push_back(child);
+                return true;
+            },
+            mSize);
+        return result;
+    }
+
+    /** @returns a view of a descendant
+     *
+     * @param[in] path Names separated by slashes; array items are designated by their index
+     *                 (e.g. "channels/3/gain").
+     * @throws structure::ChildNotFound if there is no such descendant
+     */
+    View getChild(const std::string &path) const
+    {
+        auto separator = path.find('/');
+        auto name = path.substr(0, separator);
+        if (name.empty()) {
+            return separator == std::string::npos ? *this : getChild(path.substr(separator + 1));
+        }
+
+        auto found = findChild(name);
+        if (found == nullptr) {
+            throw structure::ChildNotFound(getName(), name);
+        }
+        return separator == std::string::npos ? *found
+                                              : found->getChild(path.substr(separator + 1));
+    }
+
+    /** @returns the storage of a field, which must be exactly of type Storage
+     *
+     * @throws structure::ValueStructureMismatch if the view is not that of a field or if the
+     *         field has another storage type
+     */
+    template <class Storage>
+    Storage get() const
+    {
+        const auto &field = getField();
+        if (field.getStorageType() != typeid(Storage)) {
+            throw structure::ValueStructureMismatch(getName(), "Not stored as the requested type");
+        }
+        return read(static_cast<Storage *>(nullptr));
+    }
+    /** Same as getChild(path).get<Storage>() */
+    template <class Storage>
+    Storage get(const std::string &path) const
+    {
+        return getChild(path).get<Storage>();
+    }
+
+    /** @returns the storage of a field, whatever its type */
+    structure::Atom getStorage() const
+    {
+        const auto &field = getField();
+        if (field.getStorageSize() == 0) {
+            return read(static_cast<std::string *>(nullptr));
+        }
+        detail::AtomCapture capture;
+        field.visitRawStorage(mData, capture);
+        return capture.get();
+    }
+
+    /** Visits the storage of all fields, in order
+     *
+     * Storages are read directly from the exported bytes. Unlike when visiting a value,
+     * visitStorage(const BlockValue &) is never called.
+     */
+    void accept(structure::StorageVisitor &visitor) const
+    {
+        const auto &node = mLayout->at(mStructure);
+        if (node.kind == Kind::Field) {
+            if (node.field->getStorageSize() == 0) {
+                visitor.visitStorage(read(static_cast<std::string *>(nullptr)));
+                return;
+            }
+            node.field->visitRawStorage(mData, visitor);
+            return;
+        }
+        forEachChild(
+            [&](const View &child) {
+                child.accept(visitor);
+                return true;
+            },
+            mSize);
+    }
+
+    /** Visits a value materialized from the view (see materialize()) */
+    void accept(structure::ValueVisitor &visitor) const { materialize()->accept(visitor); }
+
+    /** @returns a value holding a copy of the viewed one */
+    std::unique_ptr<structure::StructureValue> materialize() const
+    {
+        return binary_export::read(mStructure, mData, mSize);
+    }
+
+private:
+    using Layout = std::shared_ptr<const structure::Layout>;
+    using Kind = structure::Layout::Node::Kind;
+
+    View(Layout layout, const structure::Structure &structure, const unsigned char *data,
+         size_t available)
+        : mLayout(std::move(layout)), mStructure(structure), mData(data),
+          mSize(extent(available))
+    {
+    }
+
+    /** @returns the number of bytes taken by the value, out of the available ones */
+    size_t extent(size_t available) const
+    {
+        const auto &node = mLayout->at(mStructure);
+        if (node.size != structure::Layout::variable) {
+            if (node.size > available) {
+                throw structure::ValueStructureMismatch(getName(), "Truncated value");
+            }
+            return node.size;
+        }
+        switch (node.kind) {
+        case Kind::Field:
+            return detail::fieldSize(*node.field, mData, available);
+        case Kind::VarArray:
+            return available;
+        default:
+            size_t size = 0;
+            forEachChild(
+                [&](const View &child) {
+                    size += child.mSize;
+                    return true;
+                },
+                available);
+            return size;
+        }
+    }
+
+    /** @returns a view of the child with the given name or, for arrays, index; null if none */
+    std::unique_ptr<View> findChild(const std::string &name) const
+    {
+        const auto &node = mLayout->at(mStructure);
+        auto index = node.kind == Kind::Block ? std::string::npos : parseIndex(name);
+
+        if (index != std::string::npos) {
+            // Items of fixed size can be jumped to.
+            auto itemSize = mLayout->at(*node.children[0]).size;
+            size_t first = 0;
+            if (node.kind == Kind::PrefixedArray) {
+                first = detail::fieldSize(*node.prefix, mData, mSize);
+            }
+            if (itemSize != structure::Layout::variable and itemSize != 0) {
+                if (index >= (mSize - first) / itemSize) {
+                    return nullptr;
+                }
+                auto offset = first + index * itemSize;
+                return std::unique_ptr<View>(
+                    new View(mLayout, *node.children[0], mData + offset, mSize - offset));
+            }
+            if (first != 0) {
+                // The prefix comes first
+                ++index;
+            }
+        }
+
+        std::unique_ptr<View> found;
+        size_t current = 0;
+        forEachChild(
+            [&](const View &child) {
+                if (index == std::string::npos ? child.getName() == name : current == index) {
+                    found.reset(new View(child));
+                    return false;
+                }
+                ++current;
+                return true;
+            },
+            mSize);
+        return found;
+    }
+
+    /** Calls `function` with a view of each child until it returns false
+     *
+     * @param[in] available The number of bytes available to the children
+     */
+    template <class Function>
+    void forEachChild(Function function, size_t available) const
+    {
+        const auto &node = mLayout->at(mStructure);
+        size_t offset = 0;
+        auto next = [&](const structure::Structure &child) {
+            View view(mLayout, child, mData + offset, available - offset);
+            offset += view.mSize;
+            return function(view);
+        };
+
+        switch (node.kind) {
+        case Kind::Field:
+            throw structure::NotABlock(getName());
+        case Kind::Block:
+            for (size_t i = 0; i < node.children.size(); ++i) {
+                if (not node.offsets.empty()) {
+                    offset = node.offsets[i];
+                }
+                if (not next(*node.children[i])) {
+                    return;
+                }
+            }
+            return;
+        case Kind::Array:
+            for (size_t i = 0; i < node.count; ++i) {
+                if (not next(*node.children[0])) {
+                    return;
+                }
+            }
+            return;
+        case Kind::VarArray:
+            while (offset < available) {
+                auto previous = offset;
+                if (not next(*node.children[0]) or offset == previous) {
+                    // Items taking no byte at all can't be counted.
+                    return;
+                }
+            }
+            return;
+        case Kind::PrefixedArray: {
+            View prefix(mLayout, *node.prefix, mData, available);
+            offset = prefix.mSize;
+            if (not function(prefix)) {
+                return;
+            }
+            auto count = prefix.getStorage().as<unsigned long long>();
+            for (unsigned long long i = 0; i < count; ++i) {
+                if (not next(*node.children[0])) {
+                    return;
+                }
+            }
+            return;
+        }
+        }
+    }
+
+    const structure::GenericField &getField() const
+    {
+        const auto &node = mLayout->at(mStructure);
+        if (node.kind != Kind::Field) {
+            throw structure::ValueStructureMismatch(getName(), "Not a field");
+        }
+        return *node.field;
+    }
+
+    template <class T>
+    T read(T *) const
+    {
+        T value;
+        std::memcpy(&value, mData, sizeof(value));
+        return value;
+    }
+    std::string read(std::string *) const
+    {
+        return detail::readString(getField(), mData, mSize, false);
+    }
+    template <size_t Capacity>
+    structure::InlineString<Capacity> read(structure::InlineString<Capacity> *) const
+    {
+        auto extent = detail::stringExtent(getField(), mData, mSize, false);
+        return {reinterpret_cast<const char *>(mData + extent.offset), extent.length};
+    }
+
+    /** @returns the index designated by name or, if it is not a (representable) decimal number,
+     *           std::string::npos, so that it is looked up as a name
+     */
+    static size_t parseIndex(const std::string &name)
+    {
+        size_t index;
+        // convertTo checks the whole string and for overflows, but also accepts hexadecimal.
+        if (name.find_first_not_of("0123456789") != std::string::npos or
+            not structure::convertTo(name, index)) {
+            return std::string::npos;
+        }
+        return index;
+    }
+
+    Layout mLayout;
+    const structure::Structure &mStructure;
+    const unsigned char *mData;
+    size_t mSize;
+};
+} // namespace binary_export
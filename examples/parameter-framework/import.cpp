@@ -0,0 +1,661 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "import.hpp"
+#include "structure/type/stock.hpp"
+#include "structure/detail/safe_cast.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace structure;
+
+namespace
+{
+/** A string in the XML document */
+struct Span
+{
+    const char *data;
+    size_t size;
+
+    bool operator==(const char *other) const
+    {
+        return std::strlen(other) == size and std::memcmp(data, other, size) == 0;
+    }
+    bool operator==(const Span &other) const
+    {
+        return other.size == size and std::memcmp(data, other.data, size) == 0;
+    }
+    std::string str() const { return {data, size}; }
+};
+
+/** Pull parser for the subset of XML used by Parameter Framework files
+ *
+ * It only reports tags: text, comments, CDATA sections, processing instructions and document type
+ * declarations are skipped.
+ */
+class XmlReader
+{
+public:
+    struct Tag
+    {
+        Span name;
+        /** Whether this is an end tag (`</name>`) */
+        bool isEnd;
+        /** Whether this is an empty-element tag (`<name/>`) */
+        bool isEmpty;
+        /** Their values have their entities decoded */
+        std::vector<std::pair<Span, std::string>> attributes;
+
+        const std::string *find(const char *name) const
+        {
+            for (const auto &attribute : attributes) {
+                if (attribute.first == name) {
+                    return &attribute.second;
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    XmlReader(const char *begin, const char *end) : mBegin(begin), mCurrent(begin), mEnd(end) {}
+
+    /** Reads the next tag
+     *
+     * @returns false at the end of the document
+     */
+    bool next(Tag &tag)
+    {
+        while (true) {
+            mCurrent = std::find(mCurrent, mEnd, '<');
+            if (mCurrent == mEnd) {
+                return false;
+            }
+            if (startsWith("<?")) {
+                skipPast("?>");
+            } else if (startsWith("<!--")) {
+                skipPast("-->");
+            } else if (startsWith("<![CDATA[")) {
+                skipPast("]]>");
+            } else if (startsWith("<!")) {
+                skipPast(">");
+            } else {
+                break;
+            }
+        }
+        ++mCurrent;
+
+        tag.attributes.clear();
+        tag.isEnd = consume('/');
+        tag.isEmpty = false;
+        tag.name = readName();
+        while (true) {
+            skipSpaces();
+            if (consume('>')) {
+                return true;
+            }
+            if (not tag.isEnd and consume('/')) {
+                expect('>');
+                tag.isEmpty = true;
+                return true;
+            }
+            if (tag.isEnd) {
+                fail("unexpected characters in end tag");
+            }
+            auto name = readName();
+            skipSpaces();
+            expect('=');
+            skipSpaces();
+            tag.attributes.emplace_back(name, std::string());
+            readValue(tag.attributes.back().second);
+        }
+    }
+
+    [[noreturn]] void fail(const std::string &message) const
+    {
+        auto line = 1 + std::count(mBegin, mCurrent, '\n');
+        throw std::runtime_error("line " + std::to_string(line) + ": " + message);
+    }
+
+private:
+    bool startsWith(const char *prefix) const
+    {
+        auto size = std::strlen(prefix);
+        return size_t(mEnd - mCurrent) >= size and std::memcmp(mCurrent, prefix, size) == 0;
+    }
+    void skipPast(const char *terminator)
+    {
+        auto size = std::strlen(terminator);
+        auto found = std::search(mCurrent, mEnd, terminator, terminator + size);
+        if (found == mEnd) {
+            fail(std::string("missing \"") + terminator + "\"");
+        }
+        mCurrent = found + size;
+    }
+    void skipSpaces()
+    {
+        while (mCurrent != mEnd and std::strchr(" \t\r\n", *mCurrent) != nullptr) {
+            ++mCurrent;
+        }
+    }
+    bool consume(char expected)
+    {
+        if (mCurrent == mEnd or *mCurrent != expected) {
+            return false;
+        }
+        ++mCurrent;
+        return true;
+    }
+    void expect(char expected)
+    {
+        if (not consume(expected)) {
+            fail(std::string("expected '") + expected + "'");
+        }
+    }
+
+    Span readName()
+    {
+        auto begin = mCurrent;
+        while (mCurrent != mEnd and std::strchr(" \t\r\n/>=\"'<", *mCurrent) == nullptr) {
+            ++mCurrent;
+        }
+        if (mCurrent == begin) {
+            fail("expected a name");
+        }
+        return {begin, size_t(mCurrent - begin)};
+    }
+
+    void readValue(std::string &value)
+    {
+        if (mCurrent == mEnd or (*mCurrent != '"' and *mCurrent != '\'')) {
+            fail("expected a quoted attribute value");
+        }
+        auto quote = *mCurrent++;
+        auto end = std::find(mCurrent, mEnd, quote);
+        if (end == mEnd) {
+            fail("unterminated attribute value");
+        }
+        while (mCurrent != end) {
+            auto entity = std::find(mCurrent, end, '&');
+            value.append(mCurrent, entity);
+            mCurrent = entity;
+            if (entity != end) {
+                readEntity(end, value);
+            }
+        }
+        ++mCurrent;
+    }
+
+    void readEntity(const char *end, std::string &value)
+    {
+        auto semicolon = std::find(mCurrent, end, ';');
+        if (semicolon == end) {
+            fail("unterminated entity");
+        }
+        std::string entity(mCurrent + 1, semicolon);
+        mCurrent = semicolon + 1;
+
+        static const std::pair<const char *, char> named[] = {
+            {"lt", '<'}, {"gt", '>'}, {"amp", '&'}, {"quot", '"'}, {"apos", '\''}};
+        for (const auto &candidate : named) {
+            if (entity == candidate.first) {
+                value += candidate.second;
+                return;
+            }
+        }
+        if (entity.size() < 2 or entity[0] != '#') {
+            fail("unknown entity \"&" + entity + ";\"");
+        }
+        bool isHex = entity[1] == 'x';
+        unsigned long code = 0;
+        try {
+            code = std::stoul(entity.substr(isHex ? 2 : 1), nullptr, isHex ? 16 : 10);
+        } catch (std::logic_error &) {
+            fail("invalid character reference \"&" + entity + ";\"");
+        }
+        appendUtf8(code, value);
+    }
+
+    void appendUtf8(unsigned long code, std::string &value) const
+    {
+        if (code < 0x80) {
+            value += char(code);
+        } else if (code < 0x800) {
+            value += char(0xc0 | (code >> 6));
+            value += char(0x80 | (code & 0x3f));
+        } else if (code < 0x10000) {
+            value += char(0xe0 | (code >> 12));
+            value += char(0x80 | ((code >> 6) & 0x3f));
+            value += char(0x80 | (code & 0x3f));
+        } else if (code < 0x110000) {
+            value += char(0xf0 | (code >> 18));
+            value += char(0x80 | ((code >> 12) & 0x3f));
+            value += char(0x80 | ((code >> 6) & 0x3f));
+            value += char(0x80 | (code & 0x3f));
+        } else {
+            fail("invalid character reference");
+        }
+    }
+
+    const char *mBegin;
+    const char *mCurrent;
+    const char *mEnd;
+};
+
+/** A block, parameter or component, as described by the XML */
+struct Node
+{
+    enum class Type
+    {
+        Block,
+        Integer,
+        FixedPoint,
+        FloatingPoint,
+        Component
+    };
+
+    Type type = Type::Block;
+    std::string name;
+    std::string description;
+    /** 0 if the node is not an array */
+    size_t arrayLength = 0;
+    /** Parameters only */
+    size_t size = 0;
+    size_t fractional = 0;
+    bool isSigned = false;
+    /** Empty if the bound is the one of the type */
+    std::string min, max;
+    /** Components only: the name of their type */
+    std::string componentType;
+    /** Blocks only */
+    std::vector<Node> children;
+};
+
+struct ComponentType
+{
+    std::string extends;
+    std::string description;
+    std::vector<Node> children;
+};
+
+using Library = std::unordered_map<std::string, ComponentType>;
+
+template <class Type>
+std::unique_ptr<Structure> makeField(const Node &node)
+{
+    return std::make_unique<Type>(node.name, attributes::Description{node.description});
+}
+
+template <class Type>
+std::unique_ptr<Structure> makeNumber(const Node &node)
+{
+    using Limits = std::numeric_limits<typename Type::Storage>;
+    using std::to_string;
+    attributes::Range<std::string> range(node.min.empty() ? to_string(Limits::lowest()) : node.min,
+                                         node.max.empty() ? to_string(Limits::max()) : node.max);
+    return std::make_unique<Type>(node.name, attributes::Description{node.description},
+                                  attributes::Range<typename Type::Storage>(range));
+}
+
+/** Instantiates NewFixedQ for each possible fractional size, since it is a template parameter */
+template <size_t size, class Storage, size_t... fractional>
+std::unique_ptr<Structure> makeFixedQ(const Node &node, std::index_sequence<fractional...>)
+{
+    using Make = std::unique_ptr<Structure> (*)(const Node &);
+    static const Make makers[] = {&makeField<NewFixedQ<size, fractional, true, Storage>>...};
+    if (node.fractional >= sizeof...(fractional)) {
+        throw std::runtime_error("'" + node.name + "': unsupported fractional size " +
+                                 std::to_string(node.fractional));
+    }
+    return makers[node.fractional](node);
+}
+
+std::unique_ptr<Structure> makeInteger(const Node &node)
+{
+    switch (node.size) {
+    case 8:
+        return node.isSigned ? makeNumber<Int8>(node) : makeNumber<UInt8>(node);
+    case 16:
+        return node.isSigned ? makeNumber<Int16>(node) : makeNumber<UInt16>(node);
+    case 32:
+        return node.isSigned ? makeNumber<Int32>(node) : makeNumber<UInt32>(node);
+    case 64:
+        return node.isSigned ? makeNumber<Int64>(node) : makeNumber<UInt64>(node);
+    }
+    throw std::runtime_error("'" + node.name + "': unsupported integer size " +
+                             std::to_string(node.size));
+}
+
+std::unique_ptr<Structure> makeFixedQ(const Node &node)
+{
+    switch (node.size) {
+    case 8:
+        return makeFixedQ<8, int8_t>(node, std::make_index_sequence<8>());
+    case 16:
+        return makeFixedQ<16, int16_t>(node, std::make_index_sequence<16>());
+    case 32:
+        return makeFixedQ<32, int32_t>(node, std::make_index_sequence<32>());
+    }
+    throw std::runtime_error("'" + node.name + "': unsupported Q number size " +
+                             std::to_string(node.size));
+}
+
+std::unique_ptr<Structure> makeFloatingPoint(const Node &node)
+{
+    switch (node.size) {
+    case 32:
+        return makeNumber<Float>(node);
+    case 64:
+        return makeNumber<Double>(node);
+    }
+    throw std::runtime_error("'" + node.name + "': unsupported floating point size " +
+                             std::to_string(node.size));
+}
+
+/** Builds structures from nodes, resolving components with the library */
+class Builder
+{
+public:
+    Builder(const Library &library) : mLibrary(library) {}
+
+    std::unique_ptr<Structure> build(const Node &node)
+    {
+        std::unique_ptr<Structure> item;
+        switch (node.type) {
+        case Node::Type::Block: {
+            auto block = std::make_unique<Block>(node.name,
+                                                 attributes::Description{node.description});
+            for (const auto &child : node.children) {
+                block->addChild(build(child));
+            }
+            item = std::move(block);
+            break;
+        }
+        case Node::Type::Component:
+            item = instantiate(node.name, node.componentType);
+            break;
+        case Node::Type::Integer:
+            item = makeInteger(node);
+            break;
+        case Node::Type::FixedPoint:
+            item = makeFixedQ(node);
+            break;
+        case Node::Type::FloatingPoint:
+            item = makeFloatingPoint(node);
+            break;
+        }
+        if (node.arrayLength == 0) {
+            return item;
+        }
+        return std::make_unique<Array>(node.name, std::move(item), node.arrayLength);
+    }
+
+    std::unique_ptr<Block> instantiate(const std::string &name, const std::string &typeName)
+    {
+        auto block = std::make_unique<Block>(
+            name, attributes::Description{find(typeName).description});
+        addChildren(*block, typeName);
+        return block;
+    }
+
+private:
+    const ComponentType &find(const std::string &typeName) const
+    {
+        auto found = mLibrary.find(typeName);
+        if (found == mLibrary.end()) {
+            throw std::runtime_error("unknown component type '" + typeName + "'");
+        }
+        return found->second;
+    }
+
+    void addChildren(Block &block, const std::string &typeName)
+    {
+        const auto &type = find(typeName);
+        if (std::find(begin(mInstantiating), end(mInstantiating), &type) !=
+            end(mInstantiating)) {
+            throw std::runtime_error("component type '" + typeName + "' contains itself");
+        }
+        mInstantiating.push_back(&type);
+        if (not type.extends.empty()) {
+            addChildren(block, type.extends);
+        }
+        for (const auto &child : type.children) {
+            block.addChild(build(child));
+        }
+        mInstantiating.pop_back();
+    }
+
+    const Library &mLibrary;
+    /** The component types being instantiated, to detect recursive definitions */
+    std::vector<const ComponentType *> mInstantiating;
+};
+
+/** Reads the XML document tag by tag, keeping component types and instances as nodes */
+class Parser
+{
+public:
+    Parser(const char *xml, size_t size) : mReader(xml, xml + size) {}
+
+    std::unique_ptr<Block> parse()
+    {
+        XmlReader::Tag tag;
+        while (mReader.next(tag)) {
+            if (not tag.isEnd) {
+                open(tag);
+            }
+            if (tag.isEnd or tag.isEmpty) {
+                close(tag.name);
+            }
+        }
+        if (not mOpen.empty()) {
+            mReader.fail("unterminated element <" + mOpen.back().name.str() + ">");
+        }
+        if (mName.empty()) {
+            mReader.fail("no Subsystem nor ComponentLibrary");
+        }
+
+        Builder builder(mLibrary);
+        auto root = std::make_unique<Block>(mName);
+        if (mLibraryOnly) {
+            for (const auto &type : mTypeNames) {
+                root->addChild(builder.instantiate(type, type));
+            }
+        }
+        for (const auto &instance : mInstances) {
+            root->addChild(builder.build(instance));
+        }
+        return root;
+    }
+
+private:
+    enum class Context
+    {
+        Document,
+        Subsystem,
+        Library,
+        /** Component types, instance definitions and parameter blocks */
+        Block,
+        /** The content of parameters is ignored */
+        Parameter
+    };
+
+    struct Open
+    {
+        Span name;
+        Context context;
+        /** Where child nodes go, for Context::Block */
+        std::vector<Node> *children;
+    };
+
+    void open(const XmlReader::Tag &tag)
+    {
+        auto context = mOpen.empty() ? Context::Document : mOpen.back().context;
+        Open next{tag.name, Context::Parameter, nullptr};
+
+        if (context == Context::Document and tag.name == "Subsystem") {
+            mName = required(tag, "Name");
+            next.context = Context::Subsystem;
+        } else if ((context == Context::Document or context == Context::Subsystem) and
+                   tag.name == "ComponentLibrary") {
+            if (context == Context::Document) {
+                mName = tag.name.str();
+                mLibraryOnly = true;
+            }
+            next.context = Context::Library;
+        } else if (context == Context::Library and tag.name == "ComponentType") {
+            auto name = required(tag, "Name");
+            auto inserted = mLibrary.emplace(name, ComponentType());
+            if (not inserted.second) {
+                mReader.fail("duplicate component type '" + name + "'");
+            }
+            mTypeNames.push_back(name);
+            auto &type = inserted.first->second;
+            type.extends = optional(tag, "Extends");
+            type.description = optional(tag, "Description");
+            next = {tag.name, Context::Block, &type.children};
+        } else if (context == Context::Subsystem and tag.name == "InstanceDefinition") {
+            next = {tag.name, Context::Block, &mInstances};
+        } else if (context == Context::Block) {
+            auto &siblings = *mOpen.back().children;
+            siblings.push_back(makeNode(tag));
+            if (siblings.back().type == Node::Type::Block) {
+                next = {tag.name, Context::Block, &siblings.back().children};
+            }
+        } else if (context != Context::Parameter) {
+            mReader.fail("unexpected element <" + tag.name.str() + ">");
+        }
+        mOpen.push_back(next);
+    }
+
+    void close(const Span &name)
+    {
+        if (mOpen.empty() or not(mOpen.back().name == name)) {
+            mReader.fail("unexpected end tag </" + name.str() + ">");
+        }
+        mOpen.pop_back();
+    }
+
+    Node makeNode(const XmlReader::Tag &tag)
+    {
+        static const char *const supported[] = {"ParameterBlock", "Component", "IntegerParameter",
+                                                 "FixedPointParameter", "FloatingPointParameter"};
+        if (std::none_of(std::begin(supported), std::end(supported),
+                         [&](const char *name) { return tag.name == name; })) {
+            mReader.fail("unsupported element <" + tag.name.str() + ">");
+        }
+
+        Node node;
+        node.name = required(tag, "Name");
+        node.description = optional(tag, "Description");
+        node.arrayLength = number(tag, "ArrayLength", 0);
+
+        if (tag.name == "ParameterBlock") {
+            node.type = Node::Type::Block;
+        } else if (tag.name == "Component") {
+            node.type = Node::Type::Component;
+            node.componentType = required(tag, "Type");
+        } else if (tag.name == "IntegerParameter") {
+            node.type = Node::Type::Integer;
+            node.size = number(tag, "Size");
+            auto isSigned = optional(tag, "Signed");
+            node.isSigned = isSigned == "true" or isSigned == "1";
+            node.min = optional(tag, "Min");
+            node.max = optional(tag, "Max");
+        } else if (tag.name == "FixedPointParameter") {
+            node.type = Node::Type::FixedPoint;
+            node.size = number(tag, "Size");
+            node.fractional = number(tag, "Fractional");
+            auto integral = number(tag, "Integral");
+            // Q numbers are signed: the sign bit takes what remains. Each part is checked on its
+            // own first, so that huge values can't wrap the sum around.
+            if (integral >= node.size or node.fractional >= node.size or
+                integral + node.fractional + 1 != node.size) {
+                mReader.fail("'" + node.name + "': Integral + Fractional + 1 must be Size");
+            }
+        } else {
+            node.type = Node::Type::FloatingPoint;
+            node.size = number(tag, "Size", 32);
+            node.min = optional(tag, "Min");
+            node.max = optional(tag, "Max");
+        }
+        return node;
+    }
+
+    std::string optional(const XmlReader::Tag &tag, const char *name) const
+    {
+        auto value = tag.find(name);
+        return value == nullptr ? std::string() : *value;
+    }
+    std::string required(const XmlReader::Tag &tag, const char *name) const
+    {
+        auto value = tag.find(name);
+        if (value == nullptr) {
+            mReader.fail("<" + tag.name.str() + "> has no " + name + " attribute");
+        }
+        return *value;
+    }
+    size_t number(const XmlReader::Tag &tag, const char *name) const
+    {
+        auto value = required(tag, name);
+        try {
+            return safe_cast<size_t>(value);
+        } catch (CastError &) {
+            mReader.fail("invalid " + std::string(name) + " \"" + value + "\"");
+        }
+    }
+    size_t number(const XmlReader::Tag &tag, const char *name, size_t defaultValue) const
+    {
+        return tag.find(name) == nullptr ? defaultValue : number(tag, name);
+    }
+
+    XmlReader mReader;
+    std::vector<Open> mOpen;
+    std::string mName;
+    bool mLibraryOnly = false;
+    Library mLibrary;
+    /** In the order of the document */
+    std::vector<std::string> mTypeNames;
+    std::vector<Node> mInstances;
+};
+} // namespace
+
+std::unique_ptr<Block> importStructure(const char *xml, size_t size)
+{
+    return Parser(xml, size).parse();
+}
+
+std::unique_ptr<Block> importStructure(std::istream &xml)
+{
+    std::string document{std::istreambuf_iterator<char>(xml), std::istreambuf_iterator<char>()};
+    return importStructure(document.data(), document.size());
+}
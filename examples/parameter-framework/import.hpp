@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/type/Block.hpp"
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+
+/** Parses Parameter Framework structure XML into a Block
+ *
+ * This is the reverse of pfw_export::exportStructure(). The following subset of the format is supported:
+ * ComponentLibrary, ComponentType (including Extends), InstanceDefinition, Component,
+ * ParameterBlock, IntegerParameter, FixedPointParameter and FloatingPointParameter, with their
+ * ArrayLength, Min, Max and Description attributes. Other elements are rejected, except inside
+ * parameters (e.g. adaptations), where they are ignored.
+ *
+ * The XML is parsed in a single pass, without building a DOM. Yet both the component types and
+ * the instance definitions are kept in memory, as trees of parameter descriptions, until the
+ * whole document has been read: the structure is only built then.
+ *
+ * @returns a block named after the subsystem, containing its instances (or, for a file which only
+ *          contains a component library, one instance of each component type)
+ * @throws std::runtime_error if the XML is malformed or uses unsupported features
+ */
+std::unique_ptr<structure::Block> importStructure(const char *xml, size_t size);
+
+/** @see importStructure(const char *, size_t) */
+std::unique_ptr<structure::Block> importStructure(std::istream &xml);
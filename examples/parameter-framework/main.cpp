@@ -26,11 +26,14 @@
  */
 #include "structure/functions.hpp"
 #include "structure/type/stock.hpp"
-#include "export.hpp"
+#include "PfwExport.hpp"
+#include "import.hpp"
 
 #include <iostream>
 
 using namespace structure;
+using pfw_export::exportStructure;
+using pfw_export::exportValue;
 
 int main(void)
 {
@@ -39,8 +42,14 @@ int main(void)
 
     auto r = root.with({{"1.2", "3.4"}, "2", "0.2"});
 
+    auto xml = exportStructure(root);
     std::cout << "- - - Structure - - -" << std::endl;
-    std::cout << exportStructure(root) << std::endl;
+    std::cout << xml << std::endl;
+
+    // Read the structure back: it is now an instance of the "Example" subsystem.
+    auto imported = importStructure(xml.data(), xml.size());
+    std::cout << "- - - Imported structure - - -" << std::endl;
+    print(std::cout, *imported);
     std::cout << "- - - Value - - -" << std::endl;
     std::cout << exportValue(*r) << std::endl;
 
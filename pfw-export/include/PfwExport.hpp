@@ -0,0 +1,533 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/type/stock.hpp"
+#include "structure/value/BlockValue.hpp"
+#include "structure/value/StructureValue.hpp"
+#include "structure/Visitor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/** Exports structures and values in the XML formats of the Parameter Framework
+ *
+ * Structures become component types and values become settings. The XML is written as the
+ * structure or value is browsed, into a Sink, through a buffer: no intermediate string is built.
+ *
+ * Supported structures are blocks, arrays (as the `ArrayLength` of their item) and integer,
+ * floating point and signed Q number fields. Values of arrays of fields are space-separated lists.
+ */
+namespace pfw_export
+{
+/** Where the XML goes */
+class Sink
+{
+public:
+    virtual ~Sink() = default;
+
+    /** @throws std::runtime_error (or a derived class) if the output fails */
+    virtual void write(const char *data, size_t size) = 0;
+};
+
+class OstreamSink : public Sink
+{
+public:
+    explicit OstreamSink(std::ostream &out) : mOut(out) {}
+
+    void write(const char *data, size_t size) override
+    {
+        mOut.write(data, static_cast<std::streamsize>(size));
+        if (not mOut) {
+            throw std::runtime_error("PFW export: could not write to the stream");
+        }
+    }
+
+private:
+    std::ostream &mOut;
+};
+
+/** Appends to a string */
+class StringSink : public Sink
+{
+public:
+    explicit StringSink(std::string &out) : mOut(out) {}
+
+    void write(const char *data, size_t size) override { mOut.append(data, size); }
+
+private:
+    std::string &mOut;
+};
+
+/** Buffers XML text and outputs it to a Sink in large chunks
+ *
+ * flush() must be called once done.
+ */
+class XmlWriter
+{
+public:
+    explicit XmlWriter(Sink &sink, size_t bufferSize = 64 * 1024)
+        : mSink(sink), mBuffer(std::max<size_t>(bufferSize, 1))
+    {
+    }
+
+    void raw(const char *data, size_t size)
+    {
+        if (size > mBuffer.size() - mSize) {
+            flush();
+            if (size >= mBuffer.size()) {
+                mSink.write(data, size);
+                return;
+            }
+        }
+        std::memcpy(mBuffer.data() + mSize, data, size);
+        mSize += size;
+    }
+    /** Writes a string literal */
+    template <size_t N>
+    void raw(const char (&literal)[N])
+    {
+        raw(literal, N - 1);
+    }
+    void raw(const std::string &text) { raw(text.data(), text.size()); }
+
+    /** Writes 4 spaces per level */
+    void indent(size_t level)
+    {
+        static const char spaces[] = "                                                        "
+                                     "        ";
+        auto size = level * 4;
+        while (size > 0) {
+            auto chunk = std::min(size, sizeof(spaces) - 1);
+            raw(spaces, chunk);
+            size -= chunk;
+        }
+    }
+
+    /** Writes text, escaping the characters which are special in attribute values */
+    void escaped(const std::string &text)
+    {
+        auto current = text.data();
+        auto end = current + text.size();
+        while (current != end) {
+            auto special = std::find_if(current, end, [](char c) {
+                return c == '&' or c == '<' or c == '>' or c == '"';
+            });
+            raw(current, size_t(special - current));
+            if (special == end) {
+                break;
+            }
+            switch (*special) {
+            case '&':
+                raw("&amp;");
+                break;
+            case '<':
+                raw("&lt;");
+                break;
+            case '>':
+                raw("&gt;");
+                break;
+            default:
+                raw("&quot;");
+                break;
+            }
+            current = special + 1;
+        }
+    }
+
+    /** Writes ` name="value"` */
+    void attribute(const char *name, const std::string &value)
+    {
+        raw(" ", 1);
+        raw(name, std::strlen(name));
+        raw("=\"");
+        escaped(value);
+        raw("\"", 1);
+    }
+    void attribute(const char *name, unsigned long long value)
+    {
+        raw(" ", 1);
+        raw(name, std::strlen(name));
+        raw("=\"");
+        number(value);
+        raw("\"", 1);
+    }
+
+    void number(unsigned long long value) { format("%llu", value); }
+    void number(long long value) { format("%lld", value); }
+    /** With the same format as std::to_string() */
+    void number(long double value) { format("%Lf", value); }
+
+    /** Outputs the buffered text to the sink */
+    void flush()
+    {
+        if (mSize != 0) {
+            mSink.write(mBuffer.data(), mSize);
+            mSize = 0;
+        }
+    }
+
+private:
+    template <class T>
+    void format(const char *format, T value)
+    {
+        char buffer[512];
+        auto size = std::snprintf(buffer, sizeof(buffer), format, value);
+        raw(buffer, std::min(static_cast<size_t>(size), sizeof(buffer) - 1));
+    }
+
+    Sink &mSink;
+    std::vector<char> mBuffer;
+    size_t mSize = 0;
+};
+
+namespace detail
+{
+[[noreturn]] inline void unsupported(const structure::Structure &structure)
+{
+    throw std::runtime_error("PFW export: '" + structure.getName() +
+                             "' is of an unsupported type (" + structure.getTypeName() + ")");
+}
+
+/** @returns the element of a field (e.g. "IntegerParameter") */
+inline const char *fieldElement(const structure::Structure &field)
+{
+    switch (field.getKind()) {
+    case structure::StructureKind::Integer:
+        return "IntegerParameter";
+    case structure::StructureKind::FloatingPoint:
+        return "FloatingPointParameter";
+    case structure::StructureKind::FixedQ:
+        if (not field.getTraits().isSigned) {
+            throw std::runtime_error(
+                "The Parameter Framework does not support unsigned Q numbers.");
+        }
+        return "FixedPointParameter";
+    default:
+        unsupported(field);
+    }
+}
+
+/** Writes the start tag of an element, without its closing '>'
+ *
+ * @param[in] array The array if the element is its item, nullptr otherwise
+ */
+inline void startTag(XmlWriter &writer, const char *element, const structure::Structure &structure,
+                     const structure::Structure *array)
+{
+    writer.raw("<", 1);
+    writer.raw(element, std::strlen(element));
+    writer.attribute("Name", (array != nullptr ? *array : structure).getName());
+
+    const auto &traits = structure.getTraits();
+    switch (traits.kind) {
+    case structure::StructureKind::Integer:
+        writer.attribute("Size", traits.size);
+        writer.raw(traits.isSigned ? " Signed=\"true\"" : " Signed=\"false\"");
+        break;
+    case structure::StructureKind::FloatingPoint:
+        writer.attribute("Size", traits.size);
+        break;
+    case structure::StructureKind::FixedQ:
+        writer.attribute("Size", traits.size);
+        writer.attribute("Integral", traits.size - traits.fractional - 1);
+        writer.attribute("Fractional", traits.fractional);
+        break;
+    default:
+        break;
+    }
+    if (array != nullptr) {
+        writer.attribute("ArrayLength", array->getTraits().count);
+    }
+}
+
+inline void endTag(XmlWriter &writer, const char *element)
+{
+    writer.raw("</", 2);
+    writer.raw(element, std::strlen(element));
+    writer.raw(">\n", 2);
+}
+
+/** @returns the item of an array, after checking that the Parameter Framework supports it */
+inline const structure::Structure &arrayItem(const structure::Structure &array)
+{
+    const auto &item = static_cast<const structure::Block &>(array).getFields()[0].get();
+    if (item.getKind() != structure::StructureKind::Block and item.getTraits().isBlock()) {
+        // Arrays of arrays have no equivalent
+        unsupported(array);
+    }
+    return item;
+}
+
+class StructureExporter
+{
+public:
+    explicit StructureExporter(XmlWriter &writer) : mWriter(writer) {}
+
+    /** @param[in] array The array if the structure is its item, nullptr otherwise */
+    void write(const structure::Structure &structure, size_t level,
+               const structure::Structure *array = nullptr)
+    {
+        switch (structure.getKind()) {
+        case structure::StructureKind::Block:
+            mWriter.indent(level);
+            startTag(mWriter, "ParameterBlock", structure, array);
+            mWriter.raw(">\n", 2);
+            writeChildren(static_cast<const structure::Block &>(structure), level + 1);
+            mWriter.indent(level);
+            endTag(mWriter, "ParameterBlock");
+            break;
+        case structure::StructureKind::Array:
+            write(arrayItem(structure), level, &structure);
+            break;
+        case structure::StructureKind::VarArray:
+        case structure::StructureKind::PrefixedArray:
+            unsupported(structure);
+        default:
+            mWriter.indent(level);
+            startTag(mWriter, fieldElement(structure), structure, array);
+            mWriter.raw("/>\n", 3);
+            break;
+        }
+    }
+
+    void writeChildren(const structure::Block &block, size_t level)
+    {
+        for (const auto &field : block.getFields()) {
+            write(field.get(), level);
+        }
+    }
+
+private:
+    XmlWriter &mWriter;
+};
+
+class ValueExporter : private structure::StorageVisitor
+{
+public:
+    explicit ValueExporter(XmlWriter &writer) : mWriter(writer) {}
+
+    /** @param[in] index The index of the value in the array containing it, if any */
+    void write(const structure::StructureValue &value, size_t level, const size_t *index = nullptr)
+    {
+        const auto &structure = value.getStructure();
+        switch (structure.getKind()) {
+        case structure::StructureKind::Block:
+            writeBlock(static_cast<const structure::BlockValue &>(value), level, index);
+            break;
+        case structure::StructureKind::Array:
+            writeArray(static_cast<const structure::BlockValue &>(value), level);
+            break;
+        case structure::StructureKind::VarArray:
+        case structure::StructureKind::PrefixedArray:
+            detail::unsupported(structure);
+        default: {
+            auto element = fieldElement(structure);
+            mWriter.indent(level);
+            startTag(mWriter, element, structure, nullptr);
+            mWriter.raw(">", 1);
+            writeField(value, structure);
+            endTag(mWriter, element);
+            break;
+        }
+        }
+    }
+
+private:
+    void writeBlock(const structure::BlockValue &block, size_t level, const size_t *index)
+    {
+        mWriter.indent(level);
+        if (index == nullptr) {
+            startTag(mWriter, "ParameterBlock", block.getStructure(), nullptr);
+        } else {
+            // Items of arrays of blocks are named after their index
+            mWriter.raw("<ParameterBlock Name=\"");
+            mWriter.number(static_cast<unsigned long long>(*index));
+            mWriter.raw("\"", 1);
+        }
+        mWriter.raw(">\n", 2);
+        for (const auto &field : block.getFields()) {
+            write(*field, level + 1);
+        }
+        mWriter.indent(level);
+        endTag(mWriter, "ParameterBlock");
+    }
+
+    void writeArray(const structure::BlockValue &array, size_t level)
+    {
+        const auto &structure = array.getStructure();
+        const auto &item = arrayItem(structure);
+        if (item.getKind() == structure::StructureKind::Block) {
+            mWriter.indent(level);
+            startTag(mWriter, "ParameterBlock", structure, nullptr);
+            mWriter.raw(">\n", 2);
+            size_t index = 0;
+            for (const auto &value : array.getFields()) {
+                write(*value, level + 1, &index);
+                ++index;
+            }
+            mWriter.indent(level);
+            endTag(mWriter, "ParameterBlock");
+            return;
+        }
+
+        auto element = fieldElement(item);
+        mWriter.indent(level);
+        startTag(mWriter, element, item, &structure);
+        mWriter.raw(">", 1);
+        bool first = true;
+        for (const auto &value : array.getFields()) {
+            if (not first) {
+                mWriter.raw(" ", 1);
+            }
+            first = false;
+            writeField(*value, item);
+        }
+        endTag(mWriter, element);
+    }
+
+    void writeField(const structure::StructureValue &value, const structure::Structure &field)
+    {
+        const auto &traits = field.getTraits();
+        mFixedQ = traits.kind == structure::StructureKind::FixedQ ? &traits : nullptr;
+        value.accept(*this);
+    }
+
+    void visitStorage(ull value) override { writeInteger(value); }
+    void visitStorage(ll value) override { writeInteger(value); }
+    void visitStorage(ld value) override { mWriter.number(value); }
+    using StorageVisitor::visitStorage;
+
+    /** Q numbers are written as their real value, i.e. their storage divided by 2^fractional */
+    template <class Integer>
+    void writeInteger(Integer value)
+    {
+        if (mFixedQ == nullptr) {
+            mWriter.number(value);
+        } else {
+            mWriter.number(std::ldexp(static_cast<ld>(value), -int(mFixedQ->fractional)));
+        }
+    }
+
+    XmlWriter &mWriter;
+    /** The traits of the Q number being written, if any */
+    const structure::StructureTraits *mFixedQ = nullptr;
+};
+} // namespace detail
+
+/** Exports a schema as a Parameter Framework subsystem
+ *
+ * The schema becomes a component type, named after it, and an instance of it.
+ *
+ * @param[in] schema The schema; it must be a Block
+ * @param[in] sink Where the XML goes
+ * @param[in] subsystem The name of the subsystem
+ * @throws std::runtime_error if the schema contains unsupported types
+ */
+inline void exportStructure(const structure::Structure &schema, Sink &sink,
+                            const std::string &subsystem = "Example")
+{
+    if (schema.getKind() != structure::StructureKind::Block) {
+        detail::unsupported(schema);
+    }
+
+    XmlWriter writer(sink);
+    writer.raw("<Subsystem xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"");
+    writer.attribute("Name", subsystem);
+    writer.raw(" Type=\"Virtual\">\n<ComponentLibrary>\n\n");
+
+    writer.indent(1);
+    writer.raw("<ComponentType");
+    writer.attribute("Name", schema.getName());
+    writer.raw(">\n", 2);
+    detail::StructureExporter(writer).writeChildren(static_cast<const structure::Block &>(schema),
+                                                    2);
+    writer.indent(1);
+    writer.raw("</ComponentType>\n\n</ComponentLibrary>\n\n<InstanceDefinition>\n");
+
+    writer.indent(1);
+    writer.raw("<Component");
+    writer.attribute("Name", schema.getName());
+    writer.attribute("Type", schema.getName());
+    writer.raw("/>\n</InstanceDefinition>\n</Subsystem>");
+    writer.flush();
+}
+
+/** @see exportStructure(const structure::Structure &, Sink &, const std::string &) */
+inline void exportStructure(const structure::Structure &schema, std::ostream &out,
+                            const std::string &subsystem = "Example")
+{
+    OstreamSink sink(out);
+    exportStructure(schema, sink, subsystem);
+}
+
+/** @see exportStructure(const structure::Structure &, Sink &, const std::string &) */
+inline std::string exportStructure(const structure::Structure &schema,
+                                   const std::string &subsystem = "Example")
+{
+    std::string result;
+    StringSink sink(result);
+    exportStructure(schema, sink, subsystem);
+    return result;
+}
+
+/** Exports a value as Parameter Framework settings
+ *
+ * @param[in] value The value
+ * @param[in] sink Where the XML goes
+ * @throws std::runtime_error if the value's structure contains unsupported types
+ */
+inline void exportValue(const structure::StructureValue &value, Sink &sink)
+{
+    XmlWriter writer(sink);
+    detail::ValueExporter(writer).write(value, 0);
+    writer.flush();
+}
+
+/** @see exportValue(const structure::StructureValue &, Sink &) */
+inline void exportValue(const structure::StructureValue &value, std::ostream &out)
+{
+    OstreamSink sink(out);
+    exportValue(value, sink);
+}
+
+/** @see exportValue(const structure::StructureValue &, Sink &) */
+inline std::string exportValue(const structure::StructureValue &value)
+{
+    std::string result;
+    StringSink sink(result);
+    exportValue(value, sink);
+    return result;
+}
+} // namespace pfw_export
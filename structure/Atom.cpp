@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "structure/value/Atom.hpp"
+#include "structure/Visitor.hpp"
+
+namespace structure
+{
+
+namespace
+{
+const char *toString(Atom::Kind kind)
+{
+    switch (kind) {
+    case Atom::Kind::Unsigned:
+        return "Unsigned";
+    case Atom::Kind::Signed:
+        return "Signed";
+    case Atom::Kind::Floating:
+        return "FloatingPoint";
+    case Atom::Kind::Boolean:
+        return "Boolean";
+    case Atom::Kind::String:
+        return "String";
+    }
+    return "Unknown";
+}
+} // namespace
+
+void Atom::accept(StorageVisitor &visitor) const
+{
+    switch (mKind) {
+    case Kind::Unsigned:
+        visitor.visitStorage(mUnsigned);
+        break;
+    case Kind::Signed:
+        visitor.visitStorage(mSigned);
+        break;
+    case Kind::Floating:
+        visitor.visitStorage(mFloating);
+        break;
+    case Kind::Boolean:
+        visitor.visitStorage(mBoolean);
+        break;
+    case Kind::String:
+        visitor.visitStorage(mString);
+        break;
+    }
+}
+
+bool Atom::equals(const Atom &other) const
+{
+    if (mKind != other.mKind) {
+        return false;
+    }
+    switch (mKind) {
+    case Kind::Unsigned:
+        return mUnsigned == other.mUnsigned;
+    case Kind::Signed:
+        return mSigned == other.mSigned;
+    case Kind::Floating:
+        // Consistent with value comparison: NaNs are equal to each other.
+        if (std::isnan(mFloating) or std::isnan(other.mFloating)) {
+            return std::isnan(mFloating) and std::isnan(other.mFloating);
+        }
+        return mFloating == other.mFloating;
+    case Kind::Boolean:
+        return mBoolean == other.mBoolean;
+    case Kind::String:
+        return mString == other.mString;
+    }
+    return false;
+}
+
+void Atom::wrongKind(const char *expected) const
+{
+    throw ParseError(std::string(toString(mKind)) + " atom, " + expected + " expected");
+}
+} // namespace structure
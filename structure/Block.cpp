@@ -27,6 +27,7 @@
 #include "structure/type/Block.hpp"
 #include "structure/Visitor.hpp"
 #include "structure/Exception.hpp"
+#include "structure/detail/Arena.hpp"
 
 #include <algorithm>
 #include <iterator>
@@ -47,6 +48,15 @@ std::vector<Block::StructureRef> Block::getFields() const
     return result;
 }
 
+void Block::fingerprint(detail::Hasher &hasher) const
+{
+    Structure::fingerprint(hasher);
+    hasher.add(mFields.size());
+    for (const auto &field : mFields) {
+        hasher.add(field->getFingerprint());
+    }
+}
+
 std::unique_ptr<StructureValue> Block::with(ValueInitializer initializer) const
 {
     return build(initializer);
@@ -66,4 +76,24 @@ std::unique_ptr<StructureValue> Block::doBuild(ValueImporter &importer,
 
     return std::move(value);
 }
+
+std::unique_ptr<StructureValue> Block::doBuildDefault() const
+{
+    auto value = std::make_unique<BlockValue>(*this);
+    for (const auto &field : mFields) {
+        value->addValue(field->buildDefault());
+    }
+    return value;
+}
+
+std::shared_ptr<StructureValue> Block::doInstantiate(
+    const StructureValue &prototype, const std::shared_ptr<detail::Arena> &arena) const
+{
+    auto value = detail::makeShared<BlockValue>(arena, *this);
+    auto field = mFields.begin();
+    for (const auto &child : static_cast<const BlockValue &>(prototype).getFields()) {
+        value->adoptValue((*field++)->instantiateFrom(*child, arena));
+    }
+    return value;
+}
 }
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "structure/CsvImporter.hpp"
+#include "structure/Exception.hpp"
+#include "structure/detail/parallel.hpp"
+#include "structure/type/GenericField.hpp"
+#include "structure/value/BlockValue.hpp"
+#include "structure/value/GenericFieldValue.hpp"
+
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+namespace structure
+{
+namespace
+{
+
+constexpr size_t noColumn = std::numeric_limits<size_t>::max();
+
+/** A record of a table, without its line break */
+struct Record
+{
+    const char *begin;
+    const char *end;
+};
+
+void addRecord(std::vector<Record> &records, const char *begin, const char *end)
+{
+    if (end != begin and end[-1] == '\r') {
+        --end;
+    }
+    if (end != begin) {
+        records.push_back({begin, end});
+    }
+}
+
+/** Splits a table in records; line breaks in quoted cells don't end records
+ *
+ * This is a cheap pass: it only looks for quotes and line breaks, so that the records can then be
+ * parsed concurrently.
+ */
+std::vector<Record> splitRecords(const char *data, size_t size)
+{
+    std::vector<Record> records;
+    const char *end = data + size;
+    const char *begin = data;
+    bool quoted = false;
+    for (const char *current = data; current != end; ++current) {
+        if (*current == '"') {
+            quoted = not quoted;
+        } else if (*current == '\n' and not quoted) {
+            addRecord(records, begin, current);
+            begin = current + 1;
+        }
+    }
+    if (quoted) {
+        throw CsvError("unterminated quoted cell at the end of the table");
+    }
+    addRecord(records, begin, end);
+    return records;
+}
+
+std::string recordError(size_t record, const std::string &details)
+{
+    return "record " + std::to_string(record) + ": " + details;
+}
+
+/** Splits a record in cells
+ *
+ * The strings of `cells` are reused from one record to the next, so that parsing a table doesn't
+ * allocate once its longest cells have been seen.
+ *
+ * @param[in] index The number of the record (the header being the first one), for error messages
+ * @returns the number of cells of the record
+ */
+size_t splitCells(const Record &record, char delimiter, std::vector<std::string> &cells,
+                  size_t index)
+{
+    size_t count = 0;
+    const char *current = record.begin;
+    while (true) {
+        if (count == cells.size()) {
+            cells.emplace_back();
+        }
+        auto &cell = cells[count++];
+
+        if (current != record.end and *current == '"') {
+            // Quoted cells end at the first single quote; double quotes stand for one quote.
+            cell.clear();
+            ++current;
+            while (true) {
+                auto quote =
+                    static_cast<const char *>(std::memchr(current, '"', record.end - current));
+                if (quote == nullptr) {
+                    throw CsvError(recordError(index, "unterminated quoted cell"));
+                }
+                cell.append(current, quote);
+                current = quote + 1;
+                if (current == record.end or *current != '"') {
+                    break;
+                }
+                cell.push_back('"');
+                ++current;
+            }
+            if (current != record.end and *current != delimiter) {
+                throw CsvError(recordError(index, "unexpected character after a quoted cell"));
+            }
+        } else {
+            auto next =
+                static_cast<const char *>(std::memchr(current, delimiter, record.end - current));
+            if (next == nullptr) {
+                next = record.end;
+            }
+            if (std::memchr(current, '"', next - current) != nullptr) {
+                throw CsvError(recordError(index, "quote in an unquoted cell"));
+            }
+            cell.assign(current, next);
+            current = next;
+        }
+
+        if (current == record.end) {
+            return count;
+        }
+        ++current; // The delimiter
+    }
+}
+} // namespace
+
+CsvImporter::CsvImporter(const Block &row, char delimiter) : mRow(row), mDelimiter(delimiter)
+{
+    if (delimiter == '"' or delimiter == '\n' or delimiter == '\r') {
+        throw CsvError("invalid delimiter");
+    }
+    addSteps(row, "");
+}
+
+void CsvImporter::addSteps(const Structure &structure, const std::string &parent)
+{
+    auto path = parent + "/" + structure.getName();
+
+    switch (structure.getKind()) {
+    case StructureKind::Block:
+        mSteps.push_back({Step::Type::EnterBlock, &structure, 0});
+        for (const auto &field : static_cast<const Block &>(structure).getFields()) {
+            addSteps(field, path);
+        }
+        mSteps.push_back({Step::Type::ExitBlock, &structure, 0});
+        return;
+    case StructureKind::Array: {
+        // Same paths as Array::build(): the items are numbered.
+        const Structure &item = static_cast<const Block &>(structure).getFields()[0];
+        mSteps.push_back({Step::Type::EnterBlock, &structure, 0});
+        for (size_t i = 0; i < structure.getTraits().count; ++i) {
+            addSteps(item, path + "/" + std::to_string(i));
+        }
+        mSteps.push_back({Step::Type::ExitBlock, &structure, 0});
+        return;
+    }
+    case StructureKind::VarArray:
+    case StructureKind::PrefixedArray:
+        throw CsvError("'" + structure.getName() + "' has a variable length");
+    default:
+        mSteps.push_back({Step::Type::Leaf, &structure, mLeafPaths.size()});
+        mLeafPaths.push_back(path);
+    }
+}
+
+std::vector<std::unique_ptr<StructureValue>> CsvImporter::import(const char *data, size_t size,
+                                                                 unsigned jobs) const
+{
+    auto records = splitRecords(data, size);
+    if (records.empty()) {
+        throw CsvError("missing header");
+    }
+
+    // Map the columns to the leaves, once for all the records.
+    std::unordered_map<std::string, size_t> leaves;
+    auto rowPrefix = "/" + mRow.getName() + "/";
+    for (size_t leaf = 0; leaf < mLeafPaths.size(); ++leaf) {
+        leaves.emplace(mLeafPaths[leaf], leaf);
+        leaves.emplace(mLeafPaths[leaf].substr(rowPrefix.size()), leaf);
+    }
+
+    std::vector<std::string> header;
+    size_t columns = splitCells(records[0], mDelimiter, header, 1);
+    std::vector<size_t> columnOfLeaf(mLeafPaths.size(), noColumn);
+    for (size_t column = 0; column < columns; ++column) {
+        auto leaf = leaves.find(header[column]);
+        if (leaf == leaves.end()) {
+            throw ChildNotFound(mRow.getName(), header[column]);
+        }
+        if (columnOfLeaf[leaf->second] != noColumn) {
+            throw CsvError("'" + header[column] + "' has several columns");
+        }
+        columnOfLeaf[leaf->second] = column;
+    }
+
+    std::vector<std::unique_ptr<StructureValue>> values(records.size() - 1);
+    detail::parallelFor(values.size(), jobs, [&](size_t, size_t first, size_t last) {
+        std::vector<std::string> cells;
+        std::vector<std::unique_ptr<BlockValue>> blocks;
+
+        for (size_t i = first; i < last; ++i) {
+            size_t index = i + 2;
+            size_t count = splitCells(records[i + 1], mDelimiter, cells, index);
+            if (count != columns) {
+                throw CsvError(recordError(index, std::to_string(count) + " cells instead of " +
+                                                      std::to_string(columns)));
+            }
+
+            for (const auto &step : mSteps) {
+                switch (step.type) {
+                case Step::Type::EnterBlock:
+                    blocks.push_back(std::make_unique<BlockValue>(
+                        static_cast<const Block &>(*step.structure)));
+                    break;
+                case Step::Type::Leaf: {
+                    auto &field = static_cast<const GenericField &>(*step.structure);
+                    auto column = columnOfLeaf[step.leaf];
+                    blocks.back()->addValue(column == noColumn
+                                                ? field.withDefault(mLeafPaths[step.leaf])
+                                                : field.with(cells[column]));
+                    break;
+                }
+                case Step::Type::ExitBlock: {
+                    auto block = std::move(blocks.back());
+                    blocks.pop_back();
+                    if (blocks.empty()) {
+                        values[i] = std::move(block);
+                    } else {
+                        blocks.back()->addValue(std::move(block));
+                    }
+                    break;
+                }
+                }
+            }
+        }
+    });
+    return values;
+}
+} // namespace structure
@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "structure/Delta.hpp"
+#include "structure/value/BlockValue.hpp"
+#include "structure/value/GenericFieldValue.hpp"
+#include "structure/Exception.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace structure
+{
+
+void Delta::add(size_t field, const Atom &before, const Atom &after)
+{
+    if (not mChanges.empty() and field <= mChanges.back().field) {
+        throw std::invalid_argument("Delta changes must be added in increasing field order");
+    }
+    mChanges.push_back({field, before, after});
+}
+
+namespace
+{
+/** Tags of the encoded atoms */
+enum Tag : unsigned char
+{
+    unsignedTag,
+    signedTag,
+    float32Tag,
+    float64Tag,
+    extendedTag,
+    falseTag,
+    trueTag,
+    stringTag
+};
+
+class Encoder
+{
+public:
+    Encoder(Delta::Encoded &out) : mOut(out) {}
+
+    void fixed(uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i) {
+            mOut.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    void varint(uint64_t value)
+    {
+        while (value >= 0x80) {
+            mOut.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        mOut.push_back(static_cast<unsigned char>(value));
+    }
+
+    void zigzag(int64_t value)
+    {
+        varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    void atom(const Atom &atom)
+    {
+        switch (atom.getKind()) {
+        case Atom::Kind::Unsigned:
+            mOut.push_back(unsignedTag);
+            varint(atom.getUnsigned());
+            break;
+        case Atom::Kind::Signed:
+            mOut.push_back(signedTag);
+            zigzag(atom.getSigned());
+            break;
+        case Atom::Kind::Floating:
+            floating(atom.getFloating());
+            break;
+        case Atom::Kind::Boolean:
+            mOut.push_back(atom.getBoolean() ? trueTag : falseTag);
+            break;
+        case Atom::Kind::String:
+            mOut.push_back(stringTag);
+            varint(atom.getString().size());
+            mOut.insert(end(mOut), begin(atom.getString()), end(atom.getString()));
+            break;
+        }
+    }
+
+private:
+    /** Use the smallest IEEE-754 format that exactly represents the value */
+    void floating(long double value)
+    {
+        // Converting a finite number out of the range of the destination type is undefined.
+        bool fitsFloat = not std::isfinite(value) or
+                         std::fabs(value) <= std::numeric_limits<float>::max();
+        bool fitsDouble = not std::isfinite(value) or
+                          std::fabs(value) <= std::numeric_limits<double>::max();
+
+        auto asFloat = fitsFloat ? static_cast<float>(value) : 0.f;
+        if (fitsFloat and (asFloat == value or std::isnan(value))) {
+            uint32_t bits;
+            std::memcpy(&bits, &asFloat, sizeof(bits));
+            mOut.push_back(float32Tag);
+            fixed(bits, sizeof(bits));
+            return;
+        }
+        auto asDouble = fitsDouble ? static_cast<double>(value) : 0.;
+        if (fitsDouble and asDouble == value) {
+            uint64_t bits;
+            std::memcpy(&bits, &asDouble, sizeof(bits));
+            mOut.push_back(float64Tag);
+            fixed(bits, sizeof(bits));
+            return;
+        }
+        // Wider than a double: encode the sign, mantissa and exponent separately.
+        int exponent;
+        long double mantissa = std::frexp(value, &exponent);
+        mOut.push_back(extendedTag);
+        mOut.push_back(mantissa < 0 ? 1 : 0);
+        fixed(static_cast<uint64_t>(std::ldexp(std::fabs(mantissa), 64)), sizeof(uint64_t));
+        zigzag(exponent);
+    }
+
+    Delta::Encoded &mOut;
+};
+
+class Decoder
+{
+public:
+    Decoder(const unsigned char *data, size_t size) : mCurrent(data), mEnd(data + size) {}
+
+    bool atEnd() const { return mCurrent == mEnd; }
+
+    unsigned char byte()
+    {
+        if (atEnd()) {
+            throw ParseError("Truncated delta");
+        }
+        return *mCurrent++;
+    }
+
+    uint64_t fixed(size_t size)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i) {
+            value |= uint64_t{byte()} << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            auto current = byte();
+            value |= uint64_t{current & 0x7fu} << shift;
+            if ((current & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw ParseError("Malformed variable-length integer in delta");
+    }
+
+    int64_t zigzag()
+    {
+        auto value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    Atom atom()
+    {
+        switch (byte()) {
+        case unsignedTag:
+            return Atom(static_cast<unsigned long long>(varint()));
+        case signedTag:
+            return Atom(static_cast<long long>(zigzag()));
+        case float32Tag: {
+            auto bits = static_cast<uint32_t>(fixed(sizeof(uint32_t)));
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return Atom(value);
+        }
+        case float64Tag: {
+            auto bits = fixed(sizeof(uint64_t));
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return Atom(value);
+        }
+        case extendedTag: {
+            bool negative = byte() != 0;
+            auto mantissa = std::ldexp(static_cast<long double>(fixed(sizeof(uint64_t))), -64);
+            auto value = std::ldexp(mantissa, static_cast<int>(zigzag()));
+            return Atom(negative ? -value : value);
+        }
+        case falseTag:
+            return Atom(false);
+        case trueTag:
+            return Atom(true);
+        case stringTag: {
+            auto size = varint();
+            if (size > static_cast<uint64_t>(mEnd - mCurrent)) {
+                throw ParseError("Truncated delta");
+            }
+            std::string value(reinterpret_cast<const char *>(mCurrent), size);
+            mCurrent += size;
+            return Atom(value);
+        }
+        default:
+            throw ParseError("Unknown atom tag in delta");
+        }
+    }
+
+private:
+    const unsigned char *mCurrent;
+    const unsigned char *mEnd;
+};
+
+/** Browses two values in parallel and collects the fields that differ */
+class Differ
+{
+public:
+    Differ(Delta &delta) : mDelta(delta) {}
+
+    void diff(const StructureValue &before, const StructureValue &after)
+    {
+        if (&before == &after) {
+            // Shared by both values (see SharedValue): nothing to compare.
+            mIndex += before.getFieldCount();
+            return;
+        }
+
+        auto beforeBlock = dynamic_cast<const BlockValue *>(&before);
+        if (beforeBlock == nullptr) {
+            auto &beforeField = dynamic_cast<const GenericFieldValue &>(before);
+            auto &afterField = dynamic_cast<const GenericFieldValue &>(after);
+            // Same equality as compare(): a NaN field is not a change, and fields that did not
+            // change need not be converted to atoms.
+            if (detail::compareStorage(beforeField, afterField) != 0) {
+                mDelta.add(mIndex, beforeField.getStorage(), afterField.getStorage());
+            }
+            ++mIndex;
+            return;
+        }
+
+        auto &afterBlock = dynamic_cast<const BlockValue &>(after);
+        if (beforeBlock->getFields().size() != afterBlock.getFields().size()) {
+            throw ValueStructureMismatch(after.getName(),
+                                         "The values have a different number of items");
+        }
+        auto afterIt = begin(afterBlock.getFields());
+        for (const auto &beforeField : beforeBlock->getFields()) {
+            diff(*beforeField, **afterIt++);
+        }
+    }
+
+private:
+    Delta &mDelta;
+    size_t mIndex = 0;
+};
+
+/** Browses a value and applies changes to its fields
+ *
+ * The fields are located and their new storages checked before any of them is modified, so that
+ * a delta is either applied completely or not at all.
+ */
+class Patcher
+{
+public:
+    Patcher(const Delta::Changes &changes) : mNext(begin(changes)), mEnd(end(changes))
+    {
+        mTargets.reserve(changes.size());
+    }
+
+    /** Finds the fields to be changed
+     *
+     * @returns whether all of them have been found
+     */
+    bool locate(StructureValue &value)
+    {
+        if (auto block = dynamic_cast<BlockValue *>(&value)) {
+            for (const auto &field : block->getFields()) {
+                auto count = field->getFieldCount();
+                if (mNext->field >= mIndex + count) {
+                    // No change in this subtree
+                    mIndex += count;
+                    continue;
+                }
+                if (locate(*field)) {
+                    return true;
+                }
+            }
+            return done();
+        }
+
+        if (mIndex++ == mNext->field) {
+            mTargets.push_back({&dynamic_cast<GenericFieldValue &>(value), &mNext->after});
+            ++mNext;
+        }
+        return done();
+    }
+
+    /** Applies the changes to the located fields */
+    void apply() const
+    {
+        for (const auto &target : mTargets) {
+            target.field->checkStorage(*target.storage);
+        }
+        for (const auto &target : mTargets) {
+            target.field->setStorage(*target.storage);
+        }
+    }
+
+private:
+    struct Target
+    {
+        GenericFieldValue *field;
+        const Atom *storage;
+    };
+
+    bool done() const { return mNext == mEnd; }
+
+    Delta::Changes::const_iterator mNext;
+    Delta::Changes::const_iterator mEnd;
+    size_t mIndex = 0;
+    std::vector<Target> mTargets;
+};
+} // namespace
+
+Delta::Encoded Delta::encode() const
+{
+    Encoded result;
+    Encoder encoder(result);
+
+    encoder.fixed(mFingerprint, sizeof(mFingerprint));
+    encoder.varint(mChanges.size());
+    size_t next = 0;
+    for (const auto &change : mChanges) {
+        encoder.varint(change.field - next);
+        next = change.field + 1;
+        encoder.atom(change.before);
+        encoder.atom(change.after);
+    }
+    return result;
+}
+
+Delta Delta::decode(const unsigned char *data, size_t size)
+{
+    Decoder decoder(data, size);
+
+    Delta result(decoder.fixed(sizeof(uint64_t)));
+    auto count = decoder.varint();
+    size_t next = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        size_t field = next + decoder.varint();
+        next = field + 1;
+        auto before = decoder.atom();
+        auto after = decoder.atom();
+        result.mChanges.push_back({field, std::move(before), std::move(after)});
+    }
+    if (not decoder.atEnd()) {
+        throw ParseError("Trailing bytes after delta");
+    }
+    return result;
+}
+
+Delta diff(const StructureValue &before, const StructureValue &after)
+{
+    if (before.getStructure() != after.getStructure()) {
+        throw ValueStructureMismatch(after.getName(), "Can't diff values of different structures");
+    }
+
+    Delta result(after.getStructure().getFingerprint());
+    Differ(result).diff(before, after);
+    return result;
+}
+
+void patch(StructureValue &value, const Delta &delta)
+{
+    if (value.getStructure().getFingerprint() != delta.getFingerprint()) {
+        throw ValueStructureMismatch(value.getName(), "The delta is for another structure");
+    }
+    if (delta.empty()) {
+        return;
+    }
+
+    Patcher patcher(delta.getChanges());
+    if (not patcher.locate(value)) {
+        throw ValueStructureMismatch(value.getName(), "The delta refers to unexisting fields");
+    }
+    patcher.apply();
+}
+} // namespace structure
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "structure/Layout.hpp"
+#include "structure/type/stock.hpp"
+#include "structure/Visitor.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace structure
+{
+
+constexpr size_t Layout::variable;
+
+namespace
+{
+using Node = Layout::Node;
+
+/** Computes the layout of every structure of a schema, children first */
+class LayoutBuilder : public StructureVisitor
+{
+public:
+    LayoutBuilder(std::unordered_map<const Structure *, Node> &nodes, LayoutPolicy policy,
+                  bool &stringEncodings)
+        : mNodes(nodes), mPolicy(policy), mStringEncodings(stringEncodings)
+    {
+    }
+
+    void visit(const GenericField &field) override
+    {
+        auto &node = mNodes[&field];
+        node.kind = Node::Kind::Field;
+        node.field = &field;
+        node.fieldCount = 1;
+        auto size = field.getStorageSize();
+        auto natural = field.getStorageAlignment();
+
+        if (size == 0) {
+            // Strings
+            using Encoding = attributes::StringEncoding::Kind;
+            node.encoding = field.getStringEncoding();
+            size = Layout::variable;
+            switch (node.encoding.mKind) {
+            case Encoding::Prefixed:
+                natural = node.encoding.mSize;
+                break;
+            case Encoding::FixedCapacity:
+                size = node.encoding.mSize;
+                break;
+            default:
+                break;
+            }
+            mStringEncodings |= node.encoding.mKind != Encoding::NulTerminated;
+        }
+        node.size = size;
+        node.alignment = alignment(field, natural);
+    }
+
+    void visit(const Block &block) override
+    {
+        auto &node = add(block, Node::Kind::Block);
+        size_t natural = 1;
+        for (auto child : node.children) {
+            natural = std::max(natural, mNodes.at(child).alignment);
+        }
+        node.alignment = alignment(block, natural);
+
+        size_t size = 0;
+        size_t fieldCount = 0;
+        for (auto child : node.children) {
+            const auto &childNode = mNodes.at(child);
+            if (childNode.size == Layout::variable) {
+                node.offsets.clear();
+                node.firstFields.clear();
+                return;
+            }
+            size = Layout::align(size, childNode.alignment);
+            node.offsets.push_back(size);
+            node.firstFields.push_back(fieldCount);
+            size += childNode.size;
+            fieldCount += childNode.fieldCount;
+        }
+        node.size = Layout::align(size, node.alignment);
+        node.fieldCount = fieldCount;
+    }
+
+    void visit(const Array &array) override
+    {
+        auto &node = add(array, Node::Kind::Array);
+        node.count = array.getSize();
+        const auto &item = mNodes.at(node.children[0]);
+        node.alignment = alignment(array, item.alignment);
+        if (item.size != Layout::variable) {
+            node.size = Layout::align(Layout::stride(item) * node.count, node.alignment);
+            node.fieldCount = item.fieldCount * node.count;
+        }
+    }
+
+    void visit(const VarArray &array) override
+    {
+        auto &node = add(array, Node::Kind::VarArray);
+        node.alignment = alignment(array, mNodes.at(node.children[0]).alignment);
+    }
+
+    void visit(const GenericPrefixedArray &array) override
+    {
+        array.getPrefix().accept(*this);
+        auto &node = add(array, Node::Kind::PrefixedArray);
+        node.prefix = &array.getPrefix();
+        node.alignment = alignment(array, std::max(mNodes.at(node.prefix).alignment,
+                                                   mNodes.at(node.children[0]).alignment));
+    }
+
+private:
+    Node &add(const Block &block, Node::Kind kind)
+    {
+        std::vector<const Structure *> children;
+        for (const auto &child : block.getFields()) {
+            children.push_back(&child.get());
+            child.get().accept(*this);
+        }
+        // Adding nodes may invalidate references: only get ours once children are done.
+        auto &node = mNodes[&block];
+        node.kind = kind;
+        node.children = std::move(children);
+        return node;
+    }
+
+    /** @returns the alignment of a structure, given the natural one */
+    size_t alignment(const Structure &structure, size_t natural) const
+    {
+        switch (mPolicy) {
+        case LayoutPolicy::Natural:
+            return std::max(natural, structure.getAlignment());
+        case LayoutPolicy::Explicit:
+            return std::max<size_t>(1, structure.getAlignment());
+        default:
+            return 1;
+        }
+    }
+
+    std::unordered_map<const Structure *, Node> &mNodes;
+    LayoutPolicy mPolicy;
+    bool &mStringEncodings;
+};
+} // namespace
+
+Layout::Layout(const Structure &root, LayoutPolicy policy) : mRoot(root), mPolicy(policy)
+{
+    LayoutBuilder builder(mNodes, policy, mStringEncodings);
+    root.accept(builder);
+}
+
+Layout::Location Layout::locate(size_t field) const
+{
+    const auto *node = &getRoot();
+    if (node->size == variable) {
+        throw std::logic_error("Fields can only be located in fixed-size layouts");
+    }
+    if (field >= node->fieldCount) {
+        throw std::out_of_range("No field #" + std::to_string(field) + " in the layout");
+    }
+
+    size_t offset = 0;
+    while (node->kind != Node::Kind::Field) {
+        if (node->kind == Node::Kind::Array) {
+            const auto &item = at(*node->children[0]);
+            offset += field / item.fieldCount * stride(item);
+            field %= item.fieldCount;
+            node = &item;
+            continue;
+        }
+        // The last child whose first field is not after the searched one
+        auto first = std::upper_bound(begin(node->firstFields), end(node->firstFields), field);
+        auto index = static_cast<size_t>(std::distance(begin(node->firstFields), first)) - 1;
+        offset += node->offsets[index];
+        field -= node->firstFields[index];
+        node = &at(*node->children[index]);
+    }
+    return {offset, *node->field};
+}
+} // namespace structure
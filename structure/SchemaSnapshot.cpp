@@ -0,0 +1,599 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "structure/SchemaSnapshot.hpp"
+#include "structure/Exception.hpp"
+#include "structure/type/stock.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// A snapshot is made of:
+// - a header: "LSSS" followed by the format version;
+// - a table of strings: their number, then each string (its length and its characters);
+// - the root structure.
+// Each structure is made of its kind, name, description and alignment, then the properties
+// specific to its kind (including its children) and finally its metadata. Integers are unsigned
+// LEB128 varints (zigzag-encoded if signed) and strings are indices in the table.
+
+namespace structure
+{
+namespace
+{
+
+const char magic[] = {'L', 'S', 'S', 'S'};
+const uint64_t formatVersion = 1;
+
+/** The largest capacity of fixed strings in snapshots; capacities must be powers of two */
+constexpr size_t maxFixedStringCapacity = 256;
+
+bool sameTraits(const StructureTraits &lhs, const StructureTraits &rhs)
+{
+    return lhs.kind == rhs.kind and lhs.isSigned == rhs.isSigned and lhs.size == rhs.size and
+           lhs.fractional == rhs.fractional;
+}
+
+/** Calls `function(static_cast<Type *>(nullptr))` if Type has the given traits */
+template <class Type, class Function>
+bool withType(const StructureTraits &traits, Function &function)
+{
+    if (not sameTraits(traits, Type::traits())) {
+        return false;
+    }
+    function(static_cast<Type *>(nullptr));
+    return true;
+}
+
+template <size_t Capacity, class Function>
+typename std::enable_if<(Capacity > maxFixedStringCapacity), bool>::type withFixedStringType(
+    const StructureTraits &, Function &)
+{
+    return false;
+}
+template <size_t Capacity, class Function>
+typename std::enable_if<(Capacity <= maxFixedStringCapacity), bool>::type withFixedStringType(
+    const StructureTraits &traits, Function &function)
+{
+    return withType<FixedString<Capacity>>(traits, function) or
+           withFixedStringType<Capacity * 2>(traits, function);
+}
+
+/** Calls `function(static_cast<Type *>(nullptr))` with the stock integer type of the given traits
+ *
+ * @returns whether there is one
+ */
+template <class Function>
+bool withIntegerType(const StructureTraits &traits, Function &&function)
+{
+    return withType<UInt8>(traits, function) or withType<Int8>(traits, function) or
+           withType<UInt16>(traits, function) or withType<Int16>(traits, function) or
+           withType<UInt32>(traits, function) or withType<Int32>(traits, function) or
+           withType<UInt64>(traits, function) or withType<Int64>(traits, function);
+}
+
+/** Calls `function(static_cast<Type *>(nullptr))` with the stock field type of the given traits
+ *
+ * @returns whether there is one
+ */
+template <class Function>
+bool withFieldType(const StructureTraits &traits, Function &&function)
+{
+    return withIntegerType(traits, function) or withType<Float>(traits, function) or
+           withType<Double>(traits, function) or withType<Q16f15>(traits, function) or
+           withType<UQ16f16>(traits, function) or withType<Q32f31>(traits, function) or
+           withType<String>(traits, function) or withType<Bool>(traits, function) or
+           withFixedStringType<1>(traits, function);
+}
+
+/** Calls `make()` or `make(attributes::Alignment{alignment})`
+ *
+ * Attributes can't be set to "none": they must be left out when the structure has none.
+ */
+template <class Make>
+auto withAlignment(size_t alignment, Make make) -> decltype(make())
+{
+    if (alignment == 0) {
+        return make();
+    }
+    return make(attributes::Alignment{alignment});
+}
+
+template <class Field>
+using AttributesOf = typename std::decay<decltype(std::declval<Field>().getAttributes())>::type;
+
+[[noreturn]] void unsupported(const Structure &structure)
+{
+    throw SchemaError("'" + structure.getName() + "' is of a type which can't be saved (" +
+                      structure.getTypeName() + ")");
+}
+
+class SnapshotWriter
+{
+public:
+    void write(const Structure &structure)
+    {
+        const auto &traits = structure.getTraits();
+        putByte(static_cast<uint8_t>(traits.kind));
+        putString(structure.getName());
+        putString(structure.getDescription());
+        putVarint(structure.getAlignment());
+
+        switch (traits.kind) {
+        case StructureKind::Block:
+            writeBlock<Block>(structure);
+            break;
+        case StructureKind::Array:
+            putVarint(traits.count);
+            writeBlock<Array>(structure);
+            break;
+        case StructureKind::VarArray:
+            writeBlock<VarArray>(structure);
+            break;
+        case StructureKind::PrefixedArray:
+            writePrefixedArray(static_cast<const GenericPrefixedArray &>(structure));
+            break;
+        default:
+            writeField(structure);
+            break;
+        }
+
+        const auto &metadata = structure.getMetadata();
+        putVarint(metadata.size());
+        for (const auto &entry : metadata) {
+            putString(entry.first);
+            putString(entry.second);
+        }
+    }
+
+    std::string finish() const
+    {
+        std::string header(magic, sizeof(magic));
+        putVarint(header, formatVersion);
+        putVarint(header, mStrings.size());
+        for (const auto &string : mStrings) {
+            putVarint(header, string->size());
+            header += *string;
+        }
+        return header + mNodes;
+    }
+
+private:
+    static void putVarint(std::string &out, uint64_t value)
+    {
+        do {
+            uint8_t byte = value & 0x7f;
+            value >>= 7;
+            out += static_cast<char>(value == 0 ? byte : byte | 0x80);
+        } while (value != 0);
+    }
+
+    void putByte(uint8_t value) { mNodes += static_cast<char>(value); }
+    void putVarint(uint64_t value) { putVarint(mNodes, value); }
+    void putString(const std::string &string)
+    {
+        auto inserted = mIds.emplace(string, mStrings.size());
+        if (inserted.second) {
+            mStrings.push_back(&inserted.first->first);
+        }
+        putVarint(inserted.first->second);
+    }
+
+    void putAtom(const Atom &atom)
+    {
+        putByte(static_cast<uint8_t>(atom.getKind()));
+        switch (atom.getKind()) {
+        case Atom::Kind::Unsigned:
+            putVarint(atom.getUnsigned());
+            break;
+        case Atom::Kind::Signed: {
+            auto value = static_cast<uint64_t>(atom.getSigned());
+            putVarint((value << 1) ^ (atom.getSigned() < 0 ? ~uint64_t{0} : 0));
+            break;
+        }
+        case Atom::Kind::Floating: {
+            // Hexadecimal floating point numbers are exact and don't depend on the platform.
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "%La", atom.getFloating());
+            putString(buffer);
+            break;
+        }
+        case Atom::Kind::Boolean:
+            putByte(atom.getBoolean() ? 1 : 0);
+            break;
+        case Atom::Kind::String:
+            putString(atom.getString());
+            break;
+        }
+    }
+
+    template <class Type>
+    void writeBlock(const Structure &structure)
+    {
+        // Derived types may hold more than what their kind tells.
+        if (typeid(structure) != typeid(Type)) {
+            unsupported(structure);
+        }
+        auto fields = static_cast<const Block &>(structure).getFields();
+        if (structure.getKind() == StructureKind::Block) {
+            putVarint(fields.size());
+        }
+        for (const auto &field : fields) {
+            write(field.get());
+        }
+    }
+
+    void writePrefixedArray(const GenericPrefixedArray &array)
+    {
+        const auto &prefix = array.getPrefix();
+        bool found = withIntegerType(prefix.getTraits(), [&](auto *type) {
+            using Prefix = typename std::remove_pointer<decltype(type)>::type;
+            if (typeid(array) != typeid(PrefixedArray<Prefix>)) {
+                unsupported(array);
+            }
+        });
+        if (not found) {
+            unsupported(array);
+        }
+        putTraits(prefix.getTraits());
+        putString(prefix.getName());
+        write(array.getFields()[0].get());
+    }
+
+    void writeField(const Structure &structure)
+    {
+        bool found = withFieldType(structure.getTraits(), [&](auto *type) {
+            using Type = typename std::remove_pointer<decltype(type)>::type;
+            if (typeid(structure) != typeid(Type)) {
+                unsupported(structure);
+            }
+            const auto &field = static_cast<const Type &>(structure);
+            this->putTraits(field.getTraits());
+            this->putAttributes(field.getAttributes());
+            this->putDefault(field);
+        });
+        if (not found) {
+            unsupported(structure);
+        }
+    }
+
+    void putTraits(const StructureTraits &traits)
+    {
+        putByte(traits.isSigned ? 1 : 0);
+        putVarint(traits.size);
+        putVarint(traits.fractional);
+    }
+
+    void putAttributes(const GenericFieldAttributes &) {}
+    template <class Storage>
+    void putAttributes(const NumericalAttributes<Storage> &attributes)
+    {
+        putAtom(attributes.mRange.min());
+        putAtom(attributes.mRange.max());
+    }
+    void putAttributes(const StringAttributes &attributes)
+    {
+        putByte(static_cast<uint8_t>(attributes.mEncoding.mKind));
+        putVarint(attributes.mEncoding.mSize);
+    }
+    void putAttributes(const FixedStringAttributes &attributes)
+    {
+        putVarint(attributes.mMaxLength);
+    }
+
+    void putDefault(const GenericField &field)
+    {
+        putByte(field.hasDefaultImporter() ? 1 : 0);
+        if (field.hasDefaultImporter()) {
+            putAtom(field.withDefault(field.getName())->getStorage());
+        }
+    }
+
+    std::string mNodes;
+    std::unordered_map<std::string, uint64_t> mIds;
+    std::vector<const std::string *> mStrings;
+};
+
+class SnapshotReader
+{
+public:
+    SnapshotReader(const void *data, size_t size)
+        : mCurrent(static_cast<const uint8_t *>(data)), mEnd(mCurrent + size)
+    {
+    }
+
+    std::unique_ptr<Structure> read()
+    {
+        if (size_t(mEnd - mCurrent) < sizeof(magic) or
+            std::memcmp(mCurrent, magic, sizeof(magic)) != 0) {
+            throw SchemaError("not a schema snapshot");
+        }
+        mCurrent += sizeof(magic);
+        auto version = getVarint();
+        if (version != formatVersion) {
+            throw SchemaError("unsupported format version " + std::to_string(version));
+        }
+
+        auto count = getVarint();
+        checkAvailable(count);
+        mStrings.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            auto size = getVarint();
+            checkAvailable(size);
+            mStrings.emplace_back(reinterpret_cast<const char *>(mCurrent), size);
+            mCurrent += size;
+        }
+
+        auto root = readNode();
+        if (mCurrent != mEnd) {
+            throw SchemaError("trailing bytes after the root structure");
+        }
+        return root;
+    }
+
+private:
+    /** The properties that all structures have */
+    struct Node
+    {
+        const std::string &name;
+        attributes::Description description;
+        size_t alignment;
+    };
+
+    void checkAvailable(uint64_t size) const
+    {
+        if (size > uint64_t(mEnd - mCurrent)) {
+            throw SchemaError("truncated snapshot");
+        }
+    }
+
+    uint8_t getByte()
+    {
+        checkAvailable(1);
+        return *mCurrent++;
+    }
+    uint64_t getVarint()
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = getByte();
+            value |= uint64_t{byte & 0x7fu} << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw SchemaError("invalid varint");
+    }
+    const std::string &getString()
+    {
+        auto index = getVarint();
+        if (index >= mStrings.size()) {
+            throw SchemaError("invalid string index " + std::to_string(index));
+        }
+        return mStrings[index];
+    }
+
+    Atom getAtom()
+    {
+        switch (static_cast<Atom::Kind>(getByte())) {
+        case Atom::Kind::Unsigned:
+            return getVarint();
+        case Atom::Kind::Signed: {
+            auto value = getVarint();
+            return static_cast<long long>((value >> 1) ^ (~(value & 1) + 1));
+        }
+        case Atom::Kind::Floating: {
+            const auto &string = getString();
+            char *end = nullptr;
+            long double value = std::strtold(string.c_str(), &end);
+            if (string.empty() or end != string.c_str() + string.size()) {
+                throw SchemaError("invalid floating point number \"" + string + "\"");
+            }
+            return value;
+        }
+        case Atom::Kind::Boolean:
+            return getByte() != 0;
+        case Atom::Kind::String:
+            return getString();
+        default:
+            throw SchemaError("invalid value");
+        }
+    }
+
+    StructureTraits getTraits(StructureKind kind)
+    {
+        StructureTraits traits;
+        traits.kind = kind;
+        traits.isSigned = getByte() != 0;
+        traits.size = static_cast<uint32_t>(getVarint());
+        traits.fractional = static_cast<uint32_t>(getVarint());
+        return traits;
+    }
+
+    std::unique_ptr<Structure> readNode()
+    {
+        auto kind = getByte();
+        if (kind > static_cast<uint8_t>(StructureKind::Field)) {
+            throw SchemaError("invalid kind " + std::to_string(kind));
+        }
+        Node node{getString(), {getString()}, static_cast<size_t>(getVarint())};
+
+        auto structure = readStructure(static_cast<StructureKind>(kind), node);
+
+        auto count = getVarint();
+        for (uint64_t i = 0; i < count; ++i) {
+            const auto &key = getString();
+            structure->setMetadata(key, getString());
+        }
+        return structure;
+    }
+
+    std::unique_ptr<Structure> readStructure(StructureKind kind, const Node &node)
+    {
+        switch (kind) {
+        case StructureKind::Block: {
+            auto count = getVarint();
+            auto block = withAlignment(node.alignment, [&](auto &&... attributes) {
+                return std::make_unique<Block>(node.name, node.description, attributes...);
+            });
+            for (uint64_t i = 0; i < count; ++i) {
+                block->addChild(readNode());
+            }
+            return block;
+        }
+        case StructureKind::Array: {
+            auto count = static_cast<size_t>(getVarint());
+            auto item = readNode();
+            return withAlignment(node.alignment, [&](auto &&... attributes) {
+                return std::unique_ptr<Structure>(std::make_unique<Array>(
+                    node.name, std::move(item), count, node.description, attributes...));
+            });
+        }
+        case StructureKind::VarArray: {
+            auto item = readNode();
+            return withAlignment(node.alignment, [&](auto &&... attributes) {
+                return std::unique_ptr<Structure>(std::make_unique<VarArray>(
+                    node.name, std::move(item), node.description, attributes...));
+            });
+        }
+        case StructureKind::PrefixedArray:
+            return readPrefixedArray(node);
+        default:
+            return readField(kind, node);
+        }
+    }
+
+    std::unique_ptr<Structure> readPrefixedArray(const Node &node)
+    {
+        auto traits = getTraits(StructureKind::Integer);
+        const auto &prefixName = getString();
+        auto item = readNode();
+
+        std::unique_ptr<Structure> array;
+        withIntegerType(traits, [&](auto *type) {
+            using Prefix = typename std::remove_pointer<decltype(type)>::type;
+            array = withAlignment(node.alignment, [&](auto &&... attributes) {
+                return std::unique_ptr<Structure>(std::make_unique<PrefixedArray<Prefix>>(
+                    node.name, std::move(item), prefixName, node.description, attributes...));
+            });
+        });
+        if (array == nullptr) {
+            throw SchemaError("'" + node.name + "': invalid prefix type");
+        }
+        return array;
+    }
+
+    std::unique_ptr<Structure> readField(StructureKind kind, const Node &node)
+    {
+        std::unique_ptr<Structure> field;
+        withFieldType(getTraits(kind), [&](auto *type) {
+            using Type = typename std::remove_pointer<decltype(type)>::type;
+            field = this->readAttributes<Type>(node, static_cast<AttributesOf<Type> *>(nullptr));
+        });
+        if (field == nullptr) {
+            throw SchemaError("'" + node.name + "': unknown field type");
+        }
+        return field;
+    }
+
+    template <class Type>
+    std::unique_ptr<Structure> readAttributes(const Node &node, GenericFieldAttributes *)
+    {
+        return makeField<Type>(node);
+    }
+    template <class Type, class Storage>
+    std::unique_ptr<Structure> readAttributes(const Node &node, NumericalAttributes<Storage> *)
+    {
+        auto min = getAtom().as<Storage>();
+        auto max = getAtom().as<Storage>();
+        return makeField<Type>(node, attributes::Range<Storage>(min, max));
+    }
+    template <class Type>
+    std::unique_ptr<Structure> readAttributes(const Node &node, StringAttributes *)
+    {
+        auto kind = getByte();
+        if (kind > static_cast<uint8_t>(attributes::StringEncoding::Kind::FixedCapacity)) {
+            throw SchemaError("'" + node.name + "': invalid string encoding");
+        }
+        attributes::StringEncoding encoding{static_cast<attributes::StringEncoding::Kind>(kind),
+                                            static_cast<size_t>(getVarint())};
+        return makeField<Type>(node, encoding);
+    }
+    template <class Type>
+    std::unique_ptr<Structure> readAttributes(const Node &node, FixedStringAttributes *)
+    {
+        return makeField<Type>(node, attributes::MaxLength{static_cast<size_t>(getVarint())});
+    }
+
+    template <class Type, class... Attributes>
+    std::unique_ptr<Structure> makeField(const Node &node, const Attributes &... specific)
+    {
+        if (getByte() == 0) {
+            return withAlignment(node.alignment, [&](auto &&... attributes) {
+                return std::unique_ptr<Structure>(std::make_unique<Type>(
+                    node.name, node.description, specific..., attributes...));
+            });
+        }
+        attributes::Default defaultValue{ValueInitializer(getAtom())};
+        return withAlignment(node.alignment, [&](auto &&... attributes) {
+            return std::unique_ptr<Structure>(std::make_unique<Type>(
+                node.name, node.description, specific..., defaultValue, attributes...));
+        });
+    }
+
+    const uint8_t *mCurrent;
+    const uint8_t *mEnd;
+    std::vector<std::string> mStrings;
+};
+} // namespace
+
+std::string saveSchema(const Structure &schema)
+{
+    SnapshotWriter writer;
+    writer.write(schema);
+    return writer.finish();
+}
+
+std::unique_ptr<Structure> loadSchema(const void *data, size_t size)
+{
+    try {
+        return SnapshotReader(data, size).read();
+    } catch (SchemaError &) {
+        throw;
+    } catch (std::logic_error &e) {
+        // Invalid attributes, e.g. an alignment which isn't a power of two
+        throw SchemaError(e.what());
+    } catch (std::runtime_error &e) {
+        // Invalid values, e.g. a range bound which does not fit its field
+        throw SchemaError(e.what());
+    }
+}
+} // namespace structure
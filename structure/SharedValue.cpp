@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "structure/value/SharedValue.hpp"
+#include "structure/value/BlockValue.hpp"
+#include "structure/value/GenericFieldValue.hpp"
+#include "structure/Exception.hpp"
+
+namespace structure
+{
+
+namespace
+{
+/** Copies the paths leading to changed fields and shares everything else */
+class PathCopier
+{
+public:
+    PathCopier(const Delta::Changes &changes) : mNext(begin(changes)), mEnd(end(changes)) {}
+
+    /** @returns a copy of the value, whose first field has the given index */
+    SharedValue copy(const SharedValue &value, size_t first)
+    {
+        // Changes are sorted: one below this subtree belongs to a field that was already passed.
+        if (done() or mNext->field < first or mNext->field >= first + value->getFieldCount()) {
+            return share(value);
+        }
+
+        if (auto block = dynamic_cast<const BlockValue *>(value.get())) {
+            auto result = std::make_shared<BlockValue>(block->getBlock());
+            for (const auto &field : block->getFields()) {
+                result->addShared(copy(field, first));
+                first += field->getFieldCount();
+            }
+            return result;
+        }
+
+        std::shared_ptr<StructureValue> result = value->clone();
+        dynamic_cast<GenericFieldValue &>(*result).setStorage(mNext->after);
+        ++mNext;
+        return result;
+    }
+
+    bool done() const { return mNext == mEnd; }
+
+private:
+    /** @returns the value itself or, if it is dirty, a clean copy sharing as much as possible
+     *
+     * Dirty bits must only reflect the changes being applied, yet those of shared values can't be
+     * cleared: other versions rely on them.
+     */
+    static SharedValue share(const SharedValue &value)
+    {
+        if (not value->isDirty()) {
+            return value;
+        }
+        if (auto block = dynamic_cast<const BlockValue *>(value.get())) {
+            auto result = std::make_shared<BlockValue>(block->getBlock());
+            for (const auto &field : block->getFields()) {
+                result->addShared(share(field));
+            }
+            return result;
+        }
+        return value->clone();
+    }
+
+    Delta::Changes::const_iterator mNext;
+    Delta::Changes::const_iterator mEnd;
+};
+
+SharedValue patch(const SharedValue &value, const Delta::Changes &changes)
+{
+    PathCopier copier(changes);
+    auto result = copier.copy(value, 0);
+    if (not copier.done()) {
+        throw ValueStructureMismatch(value->getName(), "The delta refers to unexisting fields");
+    }
+    return result;
+}
+} // namespace
+
+SharedValue patch(const SharedValue &value, const Delta &delta)
+{
+    if (value->getStructure().getFingerprint() != delta.getFingerprint()) {
+        throw ValueStructureMismatch(value->getName(), "The delta is for another structure");
+    }
+    return patch(value, delta.getChanges());
+}
+
+SharedValue patch(const SharedValue &value, size_t field, const Atom &storage)
+{
+    return patch(value, Delta::Changes{{field, Atom(), storage}});
+}
+} // namespace structure
@@ -25,19 +25,21 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "structure/type/Structure.hpp"
+#include "structure/type/PrefixedArray.hpp"
+#include "structure/value/BlockValue.hpp"
 #include "structure/value/StructureValue.hpp"
+#include "structure/importer/DefaultImporter.hpp"
+#include "structure/detail/Arena.hpp"
 
-namespace structure
-{
+#include <stdexcept>
 
-std::string Structure::getName() const
+namespace structure
 {
-    return mName;
-}
 
 void Structure::setMetadata(const std::string &key, const std::string &value)
 {
     mMetadata[key] = value;
+    invalidateFingerprint();
 }
 
 const std::map<std::string, std::string> &Structure::getMetadata() const
@@ -45,9 +47,146 @@ const std::map<std::string, std::string> &Structure::getMetadata() const
     return mMetadata;
 }
 
+void Structure::invalidateFingerprint()
+{
+    for (Structure *structure = this; structure != nullptr; structure = structure->mParent.get()) {
+        structure->mFingerprint.reset();
+    }
+}
+
+void Structure::invalidateLayout()
+{
+    for (Structure *structure = this; structure != nullptr; structure = structure->mParent.get()) {
+        structure->mLayout.reset();
+    }
+}
+
+void Structure::hashDefinition(detail::Hasher &hasher) const
+{
+    hasher.add(getTypeName());
+    hasher.add(mName.str());
+    hasher.add(getDescription());
+    // Only hashed when set so that the fingerprints of unaligned structures do not change.
+    if (getAlignment() != 0) {
+        hasher.add(getAlignment());
+    }
+    hasher.add(mMetadata.size());
+    for (const auto &metadata : mMetadata) {
+        hasher.add(metadata.first);
+        hasher.add(metadata.second);
+    }
+    fingerprint(hasher);
+}
+
+uint64_t Structure::getFingerprint() const
+{
+    return mFingerprint.get([this] {
+        detail::Hasher hasher;
+        hashDefinition(hasher);
+        return hasher.get();
+    });
+}
+
+int Structure::compareDefinitions(const Structure &lhs, const Structure &rhs)
+{
+    if (&lhs == &rhs) {
+        return 0;
+    }
+
+    // Children are only hashed by their fingerprints, which are compared below.
+    std::string lhsDefinition;
+    std::string rhsDefinition;
+    detail::Hasher lhsHasher(lhsDefinition);
+    detail::Hasher rhsHasher(rhsDefinition);
+    lhs.hashDefinition(lhsHasher);
+    rhs.hashDefinition(rhsHasher);
+    if (int result = lhsDefinition.compare(rhsDefinition)) {
+        return result;
+    }
+    if (lhs.getKind() != rhs.getKind()) {
+        return lhs.getKind() < rhs.getKind() ? -1 : 1;
+    }
+
+    if (lhs.getKind() == StructureKind::PrefixedArray) {
+        if (int result =
+                compareDefinitions(static_cast<const GenericPrefixedArray &>(lhs).getPrefix(),
+                                   static_cast<const GenericPrefixedArray &>(rhs).getPrefix())) {
+            return result;
+        }
+    }
+    if (lhs.getTraits().isBlock()) {
+        auto lhsFields = static_cast<const Block &>(lhs).getFields();
+        auto rhsFields = static_cast<const Block &>(rhs).getFields();
+        if (lhsFields.size() != rhsFields.size()) {
+            return lhsFields.size() < rhsFields.size() ? -1 : 1;
+        }
+        for (size_t i = 0; i < lhsFields.size(); ++i) {
+            if (int result = compareDefinitions(lhsFields[i], rhsFields[i])) {
+                return result;
+            }
+        }
+    }
+    return 0;
+}
+
+std::shared_ptr<const Layout> Structure::getLayout(LayoutPolicy policy) const
+{
+    return mLayout.get(policy, [&] { return std::make_shared<const Layout>(*this, policy); });
+}
+
+size_t StructureAttributes::checkAlignment(size_t alignment)
+{
+    if (alignment == 0 or (alignment & (alignment - 1)) != 0) {
+        throw std::invalid_argument("Alignment must be a power of two, got " +
+                                    std::to_string(alignment));
+    }
+    return alignment;
+}
+
+bool operator==(const Structure &lhs, const Structure &rhs)
+{
+    if (&lhs == &rhs) {
+        return true;
+    }
+    return lhs.getFingerprint() == rhs.getFingerprint() and
+           Structure::compareDefinitions(lhs, rhs) == 0;
+}
+
+bool operator!=(const Structure &lhs, const Structure &rhs)
+{
+    return not(lhs == rhs);
+}
+
 std::unique_ptr<StructureValue> Structure::build(ValueImporter &importer,
                                                  const std::string &path) const
 {
     return doBuild(importer, path + "/" + getName());
 }
+
+std::unique_ptr<StructureValue> Structure::doBuildDefault() const
+{
+    return build(defaultImporter);
+}
+
+std::unique_ptr<StructureValue> Structure::instantiateFrom(const StructureValue &prototype) const
+{
+    if (prototype.getStructure() != *this) {
+        throw ValueStructureMismatch(getName(), "the prototype is a value of '" +
+                                                    prototype.getName() + "'");
+    }
+    auto arena = std::make_shared<detail::Arena>();
+    auto value = instantiateFrom(prototype, arena);
+
+    // The root is returned as a std::unique_ptr: it can't live in the arena.
+    if (auto block = dynamic_cast<BlockValue *>(value.get())) {
+        return std::make_unique<BlockValue>(std::move(*block));
+    }
+    return value->clone();
+}
+
+std::shared_ptr<StructureValue> Structure::doInstantiate(
+    const StructureValue &prototype, const std::shared_ptr<detail::Arena> &) const
+{
+    return prototype.clone();
+}
 }
@@ -25,13 +25,201 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "structure/value/StructureValue.hpp"
+#include "structure/value/BlockValue.hpp"
 #include "structure/type/Structure.hpp"
+#include "structure/detail/Hasher.hpp"
+#include "structure/Visitor.hpp"
+#include "structure/Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace structure
 {
 
-std::string StructureValue::getName() const
+const std::string &StructureValue::getName() const
 {
     return getStructure().getName();
 }
+
+Symbol StructureValue::getSymbol() const
+{
+    return getStructure().getSymbol();
+}
+
+void StructureValue::checkMutable() const
+{
+    // Shared values have no parent: the walk stops at the first one anyway.
+    for (auto value = this; value != nullptr; value = value->mParent) {
+        if (value->mShared) {
+            throw ImmutableValue(getName());
+        }
+    }
+}
+
+namespace
+{
+template <class T>
+int compareScalars(const T &lhs, const T &rhs)
+{
+    return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+}
+
+/** Captures the storage of a field value, without copying strings */
+class StorageCapture : public StorageVisitor
+{
+public:
+    explicit StorageCapture(const StructureValue &value) { value.accept(*this); }
+
+    void visitStorage(ull v) override { set(Kind::Unsigned).mUnsigned = v; }
+    void visitStorage(ll v) override { set(Kind::Signed).mSigned = v; }
+    void visitStorage(ld v) override { set(Kind::Floating).mFloating = v; }
+    void visitStorage(bool v) override { set(Kind::Boolean).mBoolean = v; }
+    void visitStorage(const std::string &v) override { visitStorage(v.data(), v.size()); }
+    // Fixed strings would otherwise be wrapped in a temporary std::string.
+    void visitStorage(const char *chars, size_t size) override
+    {
+        set(Kind::String).mString = {chars, size};
+    }
+    using StorageVisitor::visitStorage;
+
+    friend int compare(const StorageCapture &lhs, const StorageCapture &rhs)
+    {
+        if (lhs.mKind != rhs.mKind) {
+            return compareScalars(lhs.mKind, rhs.mKind);
+        }
+        switch (lhs.mKind) {
+        case Kind::Unsigned:
+            return compareScalars(lhs.mUnsigned, rhs.mUnsigned);
+        case Kind::Signed:
+            return compareScalars(lhs.mSigned, rhs.mSigned);
+        case Kind::Floating:
+            // NaNs are greater than anything else (but equal to each other)
+            if (std::isnan(lhs.mFloating) or std::isnan(rhs.mFloating)) {
+                return compareScalars(std::isnan(lhs.mFloating), std::isnan(rhs.mFloating));
+            }
+            return compareScalars(lhs.mFloating, rhs.mFloating);
+        case Kind::Boolean:
+            return compareScalars(lhs.mBoolean, rhs.mBoolean);
+        case Kind::String:
+            if (int result = std::memcmp(lhs.mString.chars, rhs.mString.chars,
+                                         std::min(lhs.mString.size, rhs.mString.size))) {
+                return result;
+            }
+            return compareScalars(lhs.mString.size, rhs.mString.size);
+        }
+        return 0;
+    }
+
+private:
+    enum class Kind
+    {
+        Unsigned,
+        Signed,
+        Floating,
+        Boolean,
+        String
+    };
+
+    StorageCapture &set(Kind kind)
+    {
+        mKind = kind;
+        return *this;
+    }
+
+    Kind mKind = Kind::Unsigned;
+    union
+    {
+        ull mUnsigned;
+        ll mSigned;
+        ld mFloating;
+        bool mBoolean;
+        struct
+        {
+            const char *chars;
+            size_t size;
+        } mString;
+    };
+};
+
+class HashVisitor : public StorageVisitor
+{
+public:
+    void visitStorage(const BlockValue &block) override
+    {
+        // Hashing the number of children tells {{1, 2}, {3}} and {{1}, {2, 3}} apart.
+        mHasher.add(block.getFields().size());
+        StorageVisitor::visitStorage(block);
+    }
+    void visitStorage(ull v) override { mHasher.add(v); }
+    void visitStorage(ll v) override { mHasher.add(v); }
+    void visitStorage(ld v) override { mHasher.add(v); }
+    void visitStorage(bool v) override { mHasher.add(v); }
+    void visitStorage(const std::string &v) override { visitStorage(v.data(), v.size()); }
+    // Fixed strings would otherwise be copied into a temporary std::string.
+    void visitStorage(const char *chars, size_t size) override
+    {
+        // Hashed like Hasher::add(const std::string &)
+        mHasher.add(uint64_t{size});
+        mHasher.add(chars, size);
+    }
+    using StorageVisitor::visitStorage;
+
+    detail::Hasher mHasher;
+};
+} // namespace
+
+namespace detail
+{
+int compareStorage(const StructureValue &lhs, const StructureValue &rhs)
+{
+    // Block values are always built from blocks: their kind tells them apart without a cast.
+    bool lhsIsBlock = lhs.getStructure().getTraits().isBlock();
+    bool rhsIsBlock = rhs.getStructure().getTraits().isBlock();
+    if (not lhsIsBlock or not rhsIsBlock) {
+        if (lhsIsBlock or rhsIsBlock) {
+            // Can only happen with different structures; order fields before blocks.
+            return lhsIsBlock ? 1 : -1;
+        }
+        return compare(StorageCapture(lhs), StorageCapture(rhs));
+    }
+
+    const auto &lhsFields = static_cast<const BlockValue &>(lhs).getFields();
+    const auto &rhsFields = static_cast<const BlockValue &>(rhs).getFields();
+    auto lhsIt = begin(lhsFields);
+    auto rhsIt = begin(rhsFields);
+    for (; lhsIt != end(lhsFields) and rhsIt != end(rhsFields); ++lhsIt, ++rhsIt) {
+        if (int result = compareStorage(**lhsIt, **rhsIt)) {
+            return result;
+        }
+    }
+    return compareScalars(lhsFields.size(), rhsFields.size());
+}
+} // namespace detail
+
+int compare(const StructureValue &lhs, const StructureValue &rhs)
+{
+    if (&lhs == &rhs) {
+        return 0;
+    }
+    auto lhsFingerprint = lhs.getStructure().getFingerprint();
+    auto rhsFingerprint = rhs.getStructure().getFingerprint();
+    if (lhsFingerprint != rhsFingerprint) {
+        return compareScalars(lhsFingerprint, rhsFingerprint);
+    }
+    // Fingerprints may collide: confirm them as structure equality does.
+    if (int result = Structure::compareDefinitions(lhs.getStructure(), rhs.getStructure())) {
+        return result;
+    }
+    return detail::compareStorage(lhs, rhs);
+}
+
+uint64_t hash(const StructureValue &value)
+{
+    HashVisitor visitor;
+    visitor.mHasher.add(value.getStructure().getFingerprint());
+    value.accept(visitor);
+    return visitor.mHasher.get();
+}
 }
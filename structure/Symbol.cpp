@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "structure/Symbol.hpp"
+
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace structure
+{
+
+namespace
+{
+struct Entry
+{
+    std::string string;
+    Symbol::Id id;
+    size_t hash;
+};
+
+/** An open addressing hash set of entries, which readers browse without locking */
+class Slots
+{
+public:
+    explicit Slots(size_t count) : mMask(count - 1), mSlots(new std::atomic<const Entry *>[count])
+    {
+        for (size_t i = 0; i < count; ++i) {
+            mSlots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    size_t size() const { return mMask + 1; }
+
+    const Entry *find(const std::string &string, size_t hash) const
+    {
+        for (auto i = hash & mMask;; i = (i + 1) & mMask) {
+            auto entry = mSlots[i].load(std::memory_order_acquire);
+            if (entry == nullptr or (entry->hash == hash and entry->string == string)) {
+                return entry;
+            }
+        }
+    }
+
+    /** Must only be called by one thread at a time, with the table at most half full */
+    void insert(const Entry &entry)
+    {
+        auto i = entry.hash & mMask;
+        while (mSlots[i].load(std::memory_order_relaxed) != nullptr) {
+            i = (i + 1) & mMask;
+        }
+        mSlots[i].store(&entry, std::memory_order_release);
+    }
+
+private:
+    size_t mMask;
+    std::unique_ptr<std::atomic<const Entry *>[]> mSlots;
+};
+
+class SymbolTable
+{
+public:
+    SymbolTable() { grow(64); }
+
+    /** Lock-free */
+    const Entry *find(const std::string &string, size_t hash) const
+    {
+        return mSlots.load(std::memory_order_acquire)->find(string, hash);
+    }
+
+    const Entry &intern(const std::string &string)
+    {
+        auto hash = std::hash<std::string>{}(string);
+        // Most strings (e.g. the names of the children of a block) are interned already.
+        if (auto entry = find(string, hash)) {
+            return *entry;
+        }
+
+        std::lock_guard<std::mutex> lock(mWriters);
+        if (auto entry = find(string, hash)) {
+            // Interned by another writer in the meantime
+            return *entry;
+        }
+        if (mEntries.size() == std::numeric_limits<Symbol::Id>::max()) {
+            throw std::length_error("Too many symbols");
+        }
+        // Elements of deques never move: symbols can point to their strings.
+        mEntries.push_back({string, static_cast<Symbol::Id>(mEntries.size()), hash});
+        auto &slots = *mGenerations.back();
+        if (2 * mEntries.size() > slots.size()) {
+            grow(2 * slots.size());
+        } else {
+            slots.insert(mEntries.back());
+        }
+        return mEntries.back();
+    }
+
+private:
+    void grow(size_t count)
+    {
+        // Readers may still be browsing previous generations: they are kept. Their total size is
+        // less than the size of the current one.
+        mGenerations.push_back(std::make_unique<Slots>(count));
+        for (const auto &entry : mEntries) {
+            mGenerations.back()->insert(entry);
+        }
+        mSlots.store(mGenerations.back().get(), std::memory_order_release);
+    }
+
+    std::atomic<const Slots *> mSlots{nullptr};
+    std::mutex mWriters;
+    std::deque<Entry> mEntries;
+    std::vector<std::unique_ptr<Slots>> mGenerations;
+};
+
+SymbolTable &table()
+{
+    // Never destroyed, so that structures with static storage duration may outlive it.
+    static auto table = new SymbolTable;
+    return *table;
+}
+} // namespace
+
+Symbol::Symbol()
+{
+    static const Symbol empty{std::string()};
+    *this = empty;
+}
+
+Symbol::Symbol(const std::string &string)
+{
+    auto &entry = table().intern(string);
+    mString = &entry.string;
+    mId = entry.id;
+}
+
+bool Symbol::find(const std::string &string, Symbol &symbol)
+{
+    auto entry = table().find(string, std::hash<std::string>{}(string));
+    if (entry == nullptr) {
+        return false;
+    }
+    symbol = Symbol(&entry->string, entry->id);
+    return true;
+}
+} // namespace structure
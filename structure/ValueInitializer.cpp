@@ -25,61 +25,243 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "structure/ValueInitializer.hpp"
-#include "structure/importer/AtomImporter.hpp"
-#include "structure/importer/ListImporter.hpp"
-#include "structure/importer/WrapImporter.hpp"
+#include "structure/type/GenericField.hpp"
+#include "structure/value/Atom.hpp"
+#include "structure/value/GenericFieldValue.hpp"
+
+#include <cassert>
+#include <limits>
+#include <stdexcept>
 
 namespace structure
 {
+struct ValueInitializer::Data
+{
+    std::vector<Node> nodes;
+    std::vector<std::string> strings;
+    std::vector<Atom> storages;
+};
+
 ValueInitializer::ValueInitializer(const char *atomicValue)
-    : mImporter(new AtomImporter<decltype(atomicValue)>(atomicValue))
 {
+    mRoot.kind = Node::Kind::Text;
+    mRoot.text = atomicValue;
 }
 
 ValueInitializer::ValueInitializer(bool atomicValue)
-    : mImporter(new AtomImporter<decltype(atomicValue)>(atomicValue))
 {
+    mRoot.kind = Node::Kind::Boolean;
+    mRoot.boolean = atomicValue;
 }
 
 ValueInitializer::ValueInitializer(const std::string &atomicValue)
-    : mImporter(new AtomImporter<decltype(atomicValue)>(atomicValue))
 {
+    auto data = std::make_shared<Data>();
+    data->strings.push_back(atomicValue);
+    mRoot.kind = Node::Kind::String;
+    mRoot.index = 0;
+    mData = std::move(data);
 }
 
 ValueInitializer::ValueInitializer(long long atomicValue, void *)
-    : mImporter(new AtomImporter<decltype(atomicValue)>(atomicValue))
 {
+    mRoot.kind = Node::Kind::Signed;
+    mRoot.sgn = atomicValue;
 }
 
 ValueInitializer::ValueInitializer(unsigned long long atomicValue, void *)
-    : mImporter(new AtomImporter<decltype(atomicValue)>(atomicValue))
 {
+    mRoot.kind = Node::Kind::Unsigned;
+    mRoot.uns = atomicValue;
 }
 
 ValueInitializer::ValueInitializer(double atomicValue, void *)
-    : mImporter(new AtomImporter<decltype(atomicValue)>(atomicValue))
 {
+    mRoot.kind = Node::Kind::Floating;
+    mRoot.floating = atomicValue;
+}
+
+ValueInitializer::ValueInitializer(const Atom &storage)
+{
+    auto data = std::make_shared<Data>();
+    data->storages.push_back(storage);
+    mRoot.kind = Node::Kind::Storage;
+    mRoot.index = 0;
+    mData = std::move(data);
 }
 
-ValueInitializer::ValueInitializer(ValueImporter &importer) : mImporter(new WrapImporter(importer))
+ValueInitializer::ValueInitializer(ValueImporter &importer)
 {
+    mRoot.kind = Node::Kind::Importer;
+    mRoot.importer = &importer;
 }
+
 ValueInitializer::ValueInitializer(std::initializer_list<ValueInitializer> list)
-    : mImporter(new ListImporter(list))
 {
+    auto data = std::make_shared<Data>();
+    size_t size = 1;
+    for (const auto &item : list) {
+        size += item.mRoot.kind == Node::Kind::List ? item.mData->nodes.size() : 1;
+    }
+    if (size > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("ValueInitializer: too many values");
+    }
+    data->nodes.reserve(size);
+
+    data->nodes.emplace_back();
+    for (const auto &item : list) {
+        item.appendTo(*data);
+    }
+    auto &header = data->nodes.front();
+    header.kind = Node::Kind::List;
+    header.index = static_cast<uint32_t>(data->nodes.size());
+
+    mRoot = header;
+    mData = std::move(data);
+}
+
+void ValueInitializer::appendTo(Data &data) const
+{
+    auto base = static_cast<uint32_t>(data.nodes.size());
+    auto stringBase = static_cast<uint32_t>(data.strings.size());
+    auto storageBase = static_cast<uint32_t>(data.storages.size());
+
+    if (mData != nullptr) {
+        data.strings.insert(end(data.strings), begin(mData->strings), end(mData->strings));
+        data.storages.insert(end(data.storages), begin(mData->storages), end(mData->storages));
+    }
+    auto append = [&](Node node) {
+        switch (node.kind) {
+        case Node::Kind::List:
+            node.index += base;
+            break;
+        case Node::Kind::String:
+            node.index += stringBase;
+            break;
+        case Node::Kind::Storage:
+            node.index += storageBase;
+            break;
+        default:
+            break;
+        }
+        data.nodes.push_back(node);
+    };
+
+    if (mRoot.kind == Node::Kind::List) {
+        for (const auto &node : mData->nodes) {
+            append(node);
+        }
+    } else {
+        append(mRoot);
+    }
+}
+
+std::unique_ptr<GenericFieldValue> ValueInitializer::importAtom(const Node &node,
+                                                                const GenericField &field,
+                                                                const std::string &path) const
+{
+    switch (node.kind) {
+    case Node::Kind::Text:
+        return field.with(std::string(node.text));
+    case Node::Kind::String:
+        return field.with(mData->strings[node.index]);
+    case Node::Kind::Boolean:
+        return field.with(node.boolean);
+    case Node::Kind::Signed:
+        return field.with(node.sgn);
+    case Node::Kind::Unsigned:
+        return field.with(node.uns);
+    case Node::Kind::Floating:
+        return field.with(node.floating);
+    case Node::Kind::Storage:
+        return field.withStorage(mData->storages[node.index]);
+    case Node::Kind::Importer:
+        return node.importer->import(field, path);
+    case Node::Kind::List:
+        break;
+    }
+    throw WrongType("Atom", "Block");
 }
 
 std::unique_ptr<GenericFieldValue> ValueInitializer::import(const GenericField &field,
                                                             const std::string &path)
 {
-    return mImporter->import(field, path);
+    if (mDelegate != nullptr) {
+        return mDelegate->import(field, path);
+    }
+    if (mFrames.empty()) {
+        return importAtom(mRoot, field, path);
+    }
+
+    auto &frame = mFrames.back();
+    if (frame.next == frame.end) {
+        // We have already reached the end of this block. There's no field left to import.
+        throw NotEnoughValues(field.getName());
+    }
+    auto result = importAtom(mData->nodes[frame.next], field, path);
+    ++frame.next;
+    return result;
 }
+
 void ValueInitializer::onEnterBlock(const std::string &block)
 {
-    mImporter->onEnterBlock(block);
+    if (mDelegate != nullptr) {
+        mDelegate->onEnterBlock(block);
+        ++mDelegateDepth;
+        return;
+    }
+
+    const Node *node = &mRoot;
+    if (not mFrames.empty()) {
+        auto &frame = mFrames.back();
+        if (frame.next == frame.end) {
+            // We have already reached the end of this block. There's no block left to import.
+            throw NotEnoughValues(block);
+        }
+        node = &mData->nodes[frame.next];
+        switch (node->kind) {
+        case Node::Kind::List:
+        case Node::Kind::Importer:
+            break;
+        default:
+            throw ValueStructureMismatch(block, "Expected : \"Block\", Actual : \"Atom\".");
+        }
+    } else if (isAtom()) {
+        throw WrongType("Block", "Atom");
+    }
+
+    if (node->kind == Node::Kind::Importer) {
+        node->importer->onEnterBlock(block);
+        mDelegate = node->importer;
+        mDelegateDepth = 1;
+    }
+    // The child is consumed as a whole
+    auto index = node == &mRoot ? 0 : mFrames.back().next;
+    if (not mFrames.empty()) {
+        mFrames.back().next = node->kind == Node::Kind::List ? node->index : index + 1;
+    }
+    if (node->kind == Node::Kind::List) {
+        mFrames.push_back({index + 1, node->index});
+    }
 }
+
 void ValueInitializer::onExitBlock(const std::string &block)
 {
-    mImporter->onExitBlock(block);
+    if (mDelegate != nullptr) {
+        mDelegate->onExitBlock(block);
+        if (--mDelegateDepth == 0) {
+            mDelegate = nullptr;
+        }
+        return;
+    }
+
+    // This would be caused by a programming error in the Block class (or a descendant) calling
+    // this method.
+    assert(not mFrames.empty());
+    auto frame = mFrames.back();
+    mFrames.pop_back();
+    if (frame.next != frame.end) {
+        throw ValueStructureMismatch(block, "Exiting a Block with leftover values");
+    }
 }
 } // namespace structure
@@ -26,6 +26,8 @@
  */
 #include "structure/type/VarArray.hpp"
 #include "structure/Exception.hpp"
+#include "structure/Visitor.hpp"
+#include "structure/detail/Arena.hpp"
 
 namespace structure
 {
@@ -50,6 +52,27 @@ std::unique_ptr<StructureValue> VarArray::doBuild(ValueImporter &importer,
     return std::move(b);
 }
 
+std::unique_ptr<StructureValue> VarArray::doBuildDefault() const
+{
+    return std::make_unique<BlockValue>(*this);
+}
+
+std::shared_ptr<StructureValue> VarArray::doInstantiate(
+    const StructureValue &prototype, const std::shared_ptr<detail::Arena> &arena) const
+{
+    auto value = detail::makeShared<BlockValue>(arena, *this);
+    const auto &item = getFields()[0].get();
+    for (const auto &child : static_cast<const BlockValue &>(prototype).getFields()) {
+        value->adoptValue(item.instantiateFrom(*child, arena));
+    }
+    return value;
+}
+
+void VarArray::accept(StructureVisitor &visitor) const
+{
+    visitor.visit(*this);
+}
+
 std::string VarArray::getTypeName() const
 {
     return "VarArray";
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "structure/value/VersionedValue.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace structure
+{
+
+VersionedValue::VersionedValue(std::unique_ptr<StructureValue> initial)
+{
+    if (initial == nullptr) {
+        throw std::invalid_argument("VersionedValue: the initial value must not be null");
+    }
+    mSlots[0].value = std::move(initial);
+}
+
+VersionedValue::Snapshot VersionedValue::snapshot() const
+{
+    // Announce the reader on the slot of the latest version, then check that it is still the
+    // latest: if so, writers won't replace the slot's value until the reader is done copying it.
+    // All these operations are sequentially consistent, as are the writers' (see doPublish()).
+    while (true) {
+        auto version = mVersion.load();
+        const auto &slot = mSlots[version % slotCount];
+        slot.readers.fetch_add(1);
+        if (mVersion.load() == version) {
+            Snapshot result = slot.value;
+            slot.readers.fetch_sub(1);
+            return result;
+        }
+        slot.readers.fetch_sub(1);
+    }
+}
+
+VersionedValue::Snapshot VersionedValue::publish(std::unique_ptr<StructureValue> value)
+{
+    if (value == nullptr) {
+        throw std::invalid_argument("VersionedValue: cannot publish a null value");
+    }
+    std::lock_guard<std::mutex> lock(mWriters);
+    return doPublish(std::move(value));
+}
+
+VersionedValue::Snapshot VersionedValue::update(const Delta &delta)
+{
+    std::lock_guard<std::mutex> lock(mWriters);
+    return doPublish(patch(snapshot(), delta));
+}
+
+void VersionedValue::collect()
+{
+    std::lock_guard<std::mutex> lock(mWriters);
+    doCollect();
+}
+
+VersionedValue::Snapshot VersionedValue::doPublish(Snapshot published)
+{
+    auto next = mVersion.load() + 1;
+    auto &slot = mSlots[next % slotCount];
+
+    // The slot holds an old version: only readers which started before the publication of the
+    // latest version may still be copying it, and they are about to give up.
+    while (slot.readers.load() != 0) {
+        std::this_thread::yield();
+    }
+    if (slot.value != nullptr) {
+        mRetired.push_back(std::move(slot.value));
+    }
+    slot.value = published;
+    mVersion.store(next);
+
+    doCollect();
+    return published;
+}
+
+void VersionedValue::doCollect()
+{
+    // Retired versions can't be snapshotted anymore: once the writer holds the last reference to
+    // one of them, nobody else can acquire another.
+    mRetired.erase(std::remove_if(begin(mRetired), end(mRetired),
+                                  [](const Snapshot &version) { return version.use_count() == 1; }),
+                   end(mRetired));
+}
+} // namespace structure
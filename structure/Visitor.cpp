@@ -53,6 +53,19 @@ void StructureVisitor::visit(const Bool &s)
     visit(static_cast<const GenericField &>(s));
 }
 
+void StructureVisitor::visit(const Array &a)
+{
+    visit(static_cast<const Block &>(a));
+}
+void StructureVisitor::visit(const VarArray &a)
+{
+    visit(static_cast<const Block &>(a));
+}
+void StructureVisitor::visit(const GenericPrefixedArray &a)
+{
+    visit(static_cast<const Block &>(a));
+}
+
 void StorageVisitor::visitStorage(const BlockValue &block)
 {
     for (const auto &field : block.getFields()) {
@@ -30,8 +30,10 @@
 #include "structure/value/FieldValue.hpp"
 #include "structure/value/BlockValue.hpp"
 #include "structure/Exception.hpp"
+#include "structure/detail/parallel.hpp"
 
 #include <iostream>
+#include <sstream>
 
 namespace structure
 {
@@ -110,6 +112,45 @@ void apply(const StructureValue &structure, BlockValueFunction onEnterBlock,
     structure.accept(visitor);
 }
 
+class ApplyDirtyValueVisitor : public ValueVisitor
+{
+public:
+    ApplyDirtyValueVisitor(BlockValueFunction _onEnterBlock, BlockValueFunction _onExitBlock,
+                           FieldValueFunction _onEnterField)
+        : onEnterBlock(_onEnterBlock), onExitBlock(_onExitBlock), onEnterField(_onEnterField)
+    {
+    }
+
+    void visit(const BlockValue &block) override
+    {
+        if (not block.isDirty())
+            return;
+
+        onEnterBlock(block);
+        for (const auto &field : block.getFields())
+            field->accept(*this);
+        onExitBlock(block);
+    }
+
+    void visit(const GenericFieldValue &field) override
+    {
+        if (field.isDirty())
+            onEnterField(field);
+    }
+
+private:
+    BlockValueFunction onEnterBlock;
+    BlockValueFunction onExitBlock;
+    FieldValueFunction onEnterField;
+};
+
+void applyDirty(const StructureValue &structure, BlockValueFunction onEnterBlock,
+                BlockValueFunction onExitBlock, FieldValueFunction onEnterField)
+{
+    ApplyDirtyValueVisitor visitor(onEnterBlock, onExitBlock, onEnterField);
+    structure.accept(visitor);
+}
+
 // Functions
 
 void print(std::ostream &outStream, const Structure &structure)
@@ -145,10 +186,8 @@ void print(std::ostream &outStream, const std::unique_ptr<Block> &structure)
     print(outStream, *structure);
 }
 
-void print(std::ostream &outStream, const StructureValue &value)
+static void printValue(std::ostream &outStream, const StructureValue &value, int level)
 {
-    int level = 0;
-
     auto tab = [&]() {
         std::string tab;
         for (int i = 0; i < level; ++i)
@@ -174,11 +213,68 @@ void print(std::ostream &outStream, const StructureValue &value)
     apply(value, onEnterBlock, onExitBlock, onEnterField, true);
 }
 
+void print(std::ostream &outStream, const StructureValue &value)
+{
+    printValue(outStream, value, 0);
+}
+
+void print(std::ostream &outStream, const StructureValue &value, unsigned jobs)
+{
+    auto block = dynamic_cast<const BlockValue *>(&value);
+    if (block == nullptr or jobs <= 1) {
+        print(outStream, value);
+        return;
+    }
+
+    std::vector<std::reference_wrapper<const StructureValue>> children;
+    for (const auto &field : block->getFields()) {
+        children.push_back(*field);
+    }
+    std::vector<std::ostringstream> chunks(std::min<size_t>(jobs, children.size()));
+
+    detail::parallelFor(children.size(), jobs, [&](size_t job, size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            printValue(chunks[job], children[i], 1);
+        }
+    });
+
+    outStream << "BlockValue : " << block->getName() << " {" << std::endl;
+    for (auto &chunk : chunks) {
+        outStream << chunk.str();
+    }
+    outStream << "}" << std::endl;
+}
+
 void print(std::ostream &outStream, const std::unique_ptr<StructureValue> &value)
 {
     print(outStream, *value);
 }
 
+std::vector<std::reference_wrapper<const StructureValue>> split(const StructureValue &value,
+                                                                size_t minChunks)
+{
+    std::vector<std::reference_wrapper<const StructureValue>> chunks{value};
+
+    bool expanded = true;
+    while (expanded and chunks.size() < minChunks) {
+        expanded = false;
+        std::vector<std::reference_wrapper<const StructureValue>> next;
+        for (const StructureValue &chunk : chunks) {
+            auto block = dynamic_cast<const BlockValue *>(&chunk);
+            if (block == nullptr) {
+                next.push_back(chunk);
+                continue;
+            }
+            for (const auto &field : block->getFields()) {
+                next.push_back(*field);
+            }
+            expanded = true;
+        }
+        chunks = std::move(next);
+    }
+    return chunks;
+}
+
 std::string getValue(const StructureValue &value)
 {
     std::string result;
@@ -187,7 +283,7 @@ std::string getValue(const StructureValue &value)
         result += "{";
         auto it = b.getFields().begin();
         while (it != b.getFields().end()) {
-            result += getValue(*it);
+            result += getValue(**it);
             it++;
             if (it != b.getFields().end())
                 result += ", ";
@@ -235,8 +331,13 @@ public:
             path = "";
         }
 
+        // Names which have never been interned can't be those of any child
+        Symbol symbol;
+        if (not Symbol::find(name, symbol)) {
+            return;
+        }
         for (auto &field : block.getFields()) {
-            if (field.get().getName() == name) {
+            if (field.get().getSymbol() == symbol) {
                 if (path.empty()) {
                     mResult = std::addressof(field.get());
                     return;
@@ -296,10 +397,15 @@ public:
             path = "";
         }
 
+        // Names which have never been interned can't be those of any child
+        Symbol symbol;
+        if (not Symbol::find(name, symbol)) {
+            return;
+        }
         for (auto &field : block.getFields()) {
-            if (field->getName() == name) {
+            if (field->getSymbol() == symbol) {
                 if (path.empty()) {
-                    result = &field;
+                    result = field.get();
                     return;
                 } else {
                     field->accept(*this);
@@ -311,7 +417,7 @@ public:
     void visit(const GenericFieldValue &) override {}
 
     std::string path;
-    std::unique_ptr<StructureValue> const *result;
+    StructureValue *result;
 };
 
 StructureValue &getChild(const StructureValue &value, const std::string &path)
@@ -320,7 +426,7 @@ StructureValue &getChild(const StructureValue &value, const std::string &path)
     value.accept(visitor);
 
     if (visitor.result) {
-        return *(visitor.result->get());
+        return *visitor.result;
     }
     throw ChildNotFound(value.getName(), path);
 }
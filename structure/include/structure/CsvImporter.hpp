@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/structure_export.h"
+
+#include "structure/type/Block.hpp"
+#include "structure/value/StructureValue.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace structure
+{
+/** Imports tables of delimiter-separated values (CSV, TSV...) as values of a Block
+ *
+ * Each record (line) of the table is one value of the row Block. The first record is a header
+ * naming the leaf each column goes to, by its path relative to the row (e.g. "b/c" or, for
+ * arrays, "items/0/x") or by its full path as given to a ValueImporter (e.g. "/row/b/c"). Leaves
+ * without a column get their default value. The row may contain blocks, arrays and fields, but
+ * no variable-length array.
+ *
+ * Cells may be quoted as in RFC 4180: a quoted cell may contain delimiters and line breaks, and
+ * quotes are escaped by doubling them. Records end with "\n" or "\r\n"; empty records are ignored.
+ *
+ * The columns are mapped to the leaves once per table and the rows are built directly, without
+ * going through a ValueImporter. Cells are parsed like any other imported value (see
+ * GenericField::with()).
+ *
+ * @code
+ * Block row("row", UInt8("id"), Float("gain"));
+ * auto values = CsvImporter(row).import("id,gain\n1,0.5\n2,0.25\n");
+ * @endcode
+ */
+class STRUCTURE_EXPORT CsvImporter
+{
+public:
+    /**
+     * @param[in] row The structure of each record; it must outlive the importer
+     * @param[in] delimiter The cell delimiter, e.g. '\t' for TSV
+     * @throws CsvError if the row contains a variable-length array
+     */
+    CsvImporter(const Block &row, char delimiter = ',');
+
+    /** Builds one value per record of a table
+     *
+     * Large tables may be imported by several threads: the records are split in contiguous
+     * chunks, one per job. The values are returned in the order of the records anyway.
+     *
+     * @param[in] data The table, including its header
+     * @param[in] size The size of the table, in bytes
+     * @param[in] jobs The maximum number of concurrent jobs
+     * @returns one value per record
+     * @throws CsvError if the table is malformed or if its header doesn't match the row
+     * @throws StructureException (or std::range_error) if a cell can't be imported
+     */
+    std::vector<std::unique_ptr<StructureValue>> import(const char *data, size_t size,
+                                                        unsigned jobs = 1) const;
+    /** @see import(const char *, size_t, unsigned) const */
+    std::vector<std::unique_ptr<StructureValue>> import(const std::string &table,
+                                                        unsigned jobs = 1) const
+    {
+        return import(table.data(), table.size(), jobs);
+    }
+
+private:
+    /** A step of building a row, in preorder */
+    struct Step
+    {
+        enum class Type
+        {
+            EnterBlock,
+            ExitBlock,
+            Leaf
+        };
+        Type type;
+        /** A Block for EnterBlock, a GenericField for Leaf */
+        const Structure *structure;
+        /** Leaf: its index in mLeafPaths */
+        size_t leaf;
+    };
+
+    void addSteps(const Structure &structure, const std::string &path);
+
+    const Block &mRow;
+    char mDelimiter;
+    std::vector<Step> mSteps;
+    /** The full path of each leaf */
+    std::vector<std::string> mLeafPaths;
+};
+} // namespace structure
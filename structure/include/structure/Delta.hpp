@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/structure_export.h"
+#include "structure/value/Atom.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace structure
+{
+
+class StructureValue;
+
+/** @defgroup Delta Differences between values
+ *
+ * A Delta lists the fields that differ between two values of the same Structure. It can be
+ * applied to a value in order to bring it up to date without re-creating it, or be encoded into a
+ * compact binary form in order to only transmit the fields that changed.
+ *
+ * Fields are designated by their index in depth-first order (i.e. the order in which they are
+ * visited by a StorageVisitor or exported by binary_export::write()).
+ * @{
+ */
+
+/** A list of changes between two values of the same Structure */
+class STRUCTURE_EXPORT Delta
+{
+public:
+    /** A field which differs between two values */
+    struct Change
+    {
+        /** The index of the field, in depth-first order */
+        size_t field;
+        /** The storage of the field in the older value */
+        Atom before;
+        /** The storage of the field in the newer value */
+        Atom after;
+    };
+    using Changes = std::vector<Change>;
+    using Encoded = std::vector<unsigned char>;
+
+    /** @param[in] fingerprint The fingerprint of the Structure of the values */
+    explicit Delta(uint64_t fingerprint) : mFingerprint(fingerprint) {}
+
+    /** Add a change
+     *
+     * @throws std::invalid_argument if the field does not come after the previously added one
+     */
+    void add(size_t field, const Atom &before, const Atom &after);
+
+    uint64_t getFingerprint() const { return mFingerprint; }
+    const Changes &getChanges() const { return mChanges; }
+    bool empty() const { return mChanges.empty(); }
+
+    /** Encode the delta in a compact binary form
+     *
+     * Field indexes are encoded relatively to the previous one and integers are encoded as
+     * variable-length integers, so that a change to a small integer field typically takes 5 bytes
+     * (both the older and the newer storage are encoded).
+     */
+    Encoded encode() const;
+    /** Decode a delta encoded by encode()
+     *
+     * @throws ParseError if the input is not a valid encoded delta
+     */
+    static Delta decode(const unsigned char *data, size_t size);
+    /** See decode(const unsigned char *, size_t) */
+    static Delta decode(const Encoded &encoded) { return decode(encoded.data(), encoded.size()); }
+
+private:
+    uint64_t mFingerprint;
+    Changes mChanges;
+};
+
+/** Compute the changes between two values of the same Structure
+ *
+ * @param[in] before The older value
+ * @param[in] after The newer value
+ * @returns the changed fields
+ * @throws ValueStructureMismatch if the values do not share the same Structure or if they have a
+ *         different number of items in a variable-length array.
+ */
+STRUCTURE_EXPORT Delta diff(const StructureValue &before, const StructureValue &after);
+
+/** Apply changes to a value
+ *
+ * Only the `after` part of the changes is used.
+ *
+ * @param[in,out] value The value to be modified
+ * @param[in] delta The changes, typically computed by diff()
+ * @throws ValueStructureMismatch if the delta was computed for values of a different Structure or
+ *         refers to a field that the value does not have.
+ * @throws ParseError if a new storage does not fit in its field.
+ * @throws std::range_error if a new storage is not allowed by its field (see
+ *         GenericFieldValue::setStorage()).
+ *
+ * The value is only modified if the whole delta can be applied.
+ */
+STRUCTURE_EXPORT void patch(StructureValue &value, const Delta &delta);
+/** @} */
+} // namespace structure
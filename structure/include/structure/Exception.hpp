@@ -90,6 +90,23 @@ public:
     }
 };
 
+/** Thrown when a table can't be imported; see CsvImporter */
+class CsvError : public StructureException
+{
+public:
+    CsvError(const std::string &details) : StructureException("CSV: " + details + ".") {}
+};
+
+/** Thrown when a schema snapshot can't be saved or loaded; see saveSchema() */
+class SchemaError : public StructureException
+{
+public:
+    SchemaError(const std::string &details)
+        : StructureException("Schema snapshot: " + details + ".")
+    {
+    }
+};
+
 /** Thrown when a field does not have a Default attributes and no value was provided */
 class NoDefaultValue : public StructureException
 {
@@ -99,4 +116,14 @@ public:
     {
     }
 };
+
+/** Thrown when modifying a value shared with other blocks (see BlockValue::addShared()) */
+class ImmutableValue : public StructureException
+{
+public:
+    ImmutableValue(const std::string &self)
+        : StructureException("'" + self + "' is shared with other values and can't be modified.")
+    {
+    }
+};
 }
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/structure_export.h"
+#include "structure/attributes/StringEncoding.hpp"
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace structure
+{
+
+class Structure;
+class GenericField;
+
+/** How binary layouts align values */
+enum class LayoutPolicy
+{
+    /** No padding: each value starts right after the previous one */
+    Packed,
+    /** Like C structs: fields are aligned on the alignment of their storage type, blocks and
+     * arrays on the largest alignment of their children and fixed-size blocks are padded to a
+     * multiple of it. Alignment attributes may increase alignments further.
+     */
+    Natural,
+    /** Packed, except for structures with an Alignment attribute, which are aligned on it */
+    Explicit
+};
+
+/** Describes how the values of a Structure are laid out by binary_export
+ *
+ * In that layout, fields are laid out in depth-first order: each field takes the size of its
+ * storage, strings are encoded according to their attributes::StringEncoding (NUL-terminated by
+ * default), arrays are the concatenation of their items and prefixed arrays start with their
+ * prefix.
+ *
+ * Depending on the LayoutPolicy, padding bytes (zeros) are inserted before values so that their
+ * offset is a multiple of their alignment, and after fixed-size blocks and arrays so that their
+ * size is a multiple of their alignment. With LayoutPolicy::Natural, the layout of fixed-size
+ * values is the one a C compiler uses for the equivalent struct, so that they can be copied to
+ * and from memory without any conversion. The whole value is laid out as if it started at an
+ * offset which is a multiple of its alignment.
+ *
+ * The layout of a whole schema is computed once (see Structure::getLayout()). It tells, for each
+ * of its structures, whether their values always take the same number of bytes and, if so, where
+ * their children and fields are.
+ */
+class STRUCTURE_EXPORT Layout
+{
+public:
+    /** The size of values whose size is not fixed */
+    static constexpr size_t variable = std::numeric_limits<size_t>::max();
+
+    /** The layout of a structure of the schema */
+    struct Node
+    {
+        enum class Kind
+        {
+            Field,
+            Block,
+            Array,
+            VarArray,
+            PrefixedArray
+        };
+
+        Kind kind = Kind::Block;
+        /** The number of bytes taken by values, if fixed; `variable` otherwise
+         *
+         * This includes their tail padding, except for fields.
+         */
+        size_t size = variable;
+        /** The offset of values is a multiple of it */
+        size_t alignment = 1;
+        /** The number of fields in values, if fixed; `variable` otherwise */
+        size_t fieldCount = variable;
+        /** Fields only */
+        const GenericField *field = nullptr;
+        /** String fields only */
+        attributes::StringEncoding encoding = attributes::StringEncoding::nulTerminated();
+        /** The children of blocks; the item of arrays */
+        std::vector<const Structure *> children;
+        /** For fixed-size blocks, the offset of each child */
+        std::vector<size_t> offsets;
+        /** For fixed-size blocks, the index of the first field of each child */
+        std::vector<size_t> firstFields;
+        /** Arrays only */
+        size_t count = 0;
+        /** Prefixed arrays only */
+        const GenericField *prefix = nullptr;
+    };
+
+    /** Where a field lies in exported values */
+    struct Location
+    {
+        size_t offset;
+        const GenericField &field;
+    };
+
+    explicit Layout(const Structure &root, LayoutPolicy policy = LayoutPolicy::Packed);
+
+    /** @returns the layout of a structure of the schema
+     *
+     * @throws std::out_of_range if the structure is not part of the schema
+     */
+    const Node &at(const Structure &structure) const { return mNodes.at(&structure); }
+    /** @returns the layout of the root structure */
+    const Node &getRoot() const { return at(mRoot); }
+    LayoutPolicy getPolicy() const { return mPolicy; }
+
+    bool isFixedSize() const { return getRoot().size != variable; }
+    /** @returns whether some strings are not NUL-terminated */
+    bool hasStringEncodings() const { return mStringEncodings; }
+    /** @returns the size of values, if fixed; `variable` otherwise */
+    size_t getSize() const { return getRoot().size; }
+
+    /** @returns the location of a field, without browsing the schema
+     *
+     * @param[in] field The index of the field, in depth-first order (as in a Delta)
+     * @throws std::logic_error if values do not have a fixed size
+     * @throws std::out_of_range if there is no such field
+     */
+    Location locate(size_t field) const;
+
+    /** @returns the distance between the items of an array of `item` */
+    static size_t stride(const Node &item) { return align(item.size, item.alignment); }
+    /** @returns the smallest multiple of `alignment` which is not lower than `offset` */
+    static size_t align(size_t offset, size_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+private:
+    const Structure &mRoot;
+    LayoutPolicy mPolicy;
+    bool mStringEncodings = false;
+    std::unordered_map<const Structure *, Node> mNodes;
+};
+
+namespace detail
+{
+/** Lazily computed layouts, one per policy, which can be read and written concurrently
+ *
+ * Unlike fingerprints, layouts refer to the structures they describe: copies start empty.
+ */
+class LayoutCache
+{
+public:
+    LayoutCache() = default;
+    LayoutCache(const LayoutCache &) {}
+    LayoutCache &operator=(const LayoutCache &)
+    {
+        reset();
+        return *this;
+    }
+
+    /** @returns the cached layout, computing it with `compute()` if needed */
+    template <class Compute>
+    std::shared_ptr<const Layout> get(LayoutPolicy policy, Compute compute) const
+    {
+        auto &cached = mLayouts[static_cast<size_t>(policy)];
+        auto layout = std::atomic_load(&cached);
+        if (layout == nullptr) {
+            layout = compute();
+            std::atomic_store(&cached, layout);
+        }
+        return layout;
+    }
+
+    /** Forget the cached layouts */
+    void reset()
+    {
+        for (auto &layout : mLayouts) {
+            std::atomic_store(&layout, std::shared_ptr<const Layout>());
+        }
+    }
+
+private:
+    mutable std::array<std::shared_ptr<const Layout>, 3> mLayouts;
+};
+} // namespace detail
+} // namespace structure
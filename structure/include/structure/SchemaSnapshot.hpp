@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/structure_export.h"
+
+#include "structure/type/Structure.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace structure
+{
+/** Serializes a schema into a compact binary snapshot
+ *
+ * Snapshots hold everything that defines the schema: the types and names of its structures, their
+ * attributes (descriptions, alignments, ranges, string encodings, maximum lengths, defaults) and
+ * their metadata. They allow building large schemas offline and loading them at startup with
+ * loadSchema(), instead of evaluating the constructors' arguments (names, attributes, defaults)
+ * again.
+ *
+ * Only stock types can be saved: blocks, arrays, variable-length arrays, prefixed arrays (with a
+ * stock integer prefix) and the stock-provided fields (see @ref StockTypes) but LongDouble. Fixed
+ * strings can only be saved if their capacity is a power of two up to 256 (e.g. FixedString<12>
+ * can't): the loader needs a concrete type for each capacity. Default values are evaluated once,
+ * when saving.
+ *
+ * Snapshots don't depend on the platform. The loaded schema has the same fingerprint as the saved
+ * one (see Structure::getFingerprint()).
+ *
+ * @param[in] schema The schema to be saved
+ * @returns the snapshot
+ * @throws SchemaError if the schema contains a type which can't be saved
+ */
+STRUCTURE_EXPORT std::string saveSchema(const Structure &schema);
+
+/** Rebuilds a schema from a snapshot made by saveSchema()
+ *
+ * The snapshot is read in a single pass; its strings are decoded once no matter how many
+ * structures use them. Structures are still allocated one by one, as when built by hand.
+ *
+ * @param[in] data The snapshot
+ * @param[in] size The size of the snapshot, in bytes
+ * @returns the schema
+ * @throws SchemaError if the snapshot is invalid or truncated
+ */
+STRUCTURE_EXPORT std::unique_ptr<Structure> loadSchema(const void *data, size_t size);
+
+/** Rebuilds a schema from a snapshot made by saveSchema(); see loadSchema(const void *, size_t) */
+inline std::unique_ptr<Structure> loadSchema(const std::string &snapshot)
+{
+    return loadSchema(snapshot.data(), snapshot.size());
+}
+} // namespace structure
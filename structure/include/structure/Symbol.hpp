@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/structure_export.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace structure
+{
+/** An interned string, such as the name of a structure
+ *
+ * All the symbols with the same string share a single copy of it, held in a process-wide symbol
+ * table, and the same integer identifier. Symbols are thus cheap to copy, compare and hash. The
+ * strings are never freed: references returned by str() remain valid until the process exits.
+ *
+ * Looking strings up, be it through find() or by interning a string which already is, does not
+ * take any lock: only interning new strings does.
+ *
+ * Identifiers are only meaningful within a process: fingerprints hash the strings instead.
+ */
+class STRUCTURE_EXPORT Symbol
+{
+public:
+    using Id = uint32_t;
+
+    /** The empty string */
+    Symbol();
+    /** Interns a string */
+    explicit Symbol(const std::string &string);
+
+    /** Looks a string up without interning it
+     *
+     * This allows searching, e.g. for a child with a given name, without growing the symbol table
+     * with strings that no structure uses.
+     *
+     * @param[in] string The string to look for
+     * @param[out] symbol Its symbol, if it has been interned
+     * @returns whether the string has been interned
+     */
+    static bool find(const std::string &string, Symbol &symbol);
+
+    const std::string &str() const { return *mString; }
+    Id getId() const { return mId; }
+
+    friend bool operator==(const Symbol &lhs, const Symbol &rhs) { return lhs.mId == rhs.mId; }
+    friend bool operator!=(const Symbol &lhs, const Symbol &rhs) { return lhs.mId != rhs.mId; }
+    /** Orders symbols by identifier, which is not the alphabetical order */
+    friend bool operator<(const Symbol &lhs, const Symbol &rhs) { return lhs.mId < rhs.mId; }
+
+private:
+    Symbol(const std::string *string, Id id) : mString(string), mId(id) {}
+
+    const std::string *mString;
+    Id mId;
+};
+} // namespace structure
+
+namespace std
+{
+template <>
+struct hash<structure::Symbol>
+{
+    size_t operator()(const structure::Symbol &symbol) const { return symbol.getId(); }
+};
+} // namespace std
@@ -29,15 +29,33 @@
 #include "structure/structure_export.h"
 #include "structure/ValueImporter.hpp"
 
+#include <cstdint>
 #include <initializer_list>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace structure
 {
 
+class Atom;
 class GenericField;
 class GenericFieldValue;
 
+/** Holds the values of a StructureValue to be built, e.g. `{{"1", "2"}, 3, importer}`
+ *
+ * Nested lists are flattened into a single buffer of tagged nodes: atoms are stored inline (string
+ * literals by pointer) and importers by reference, so that importing the values does not allocate
+ * anything but the values themselves. Only lists and std::string values allocate, when the
+ * initializer is constructed.
+ *
+ * Each list must have exactly as many items as the block it initializes has children (or, for
+ * variable-length arrays, as many as the items to be built). An importer item imports a whole
+ * child, be it a field or a block.
+ *
+ * The values and importers referred to must outlive the initializer. An initializer may be used
+ * to build several values, one after the other.
+ */
 class STRUCTURE_EXPORT ValueInitializer : public ValueImporter
 {
 public:
@@ -97,6 +115,13 @@ public:
      */
     ValueInitializer(const std::string &atomicValue);
 
+    /** Constructs a ValueInitializer from the in-memory value of a field
+     *
+     * Unlike the other constructors, the value is not converted: it must fit the storage of the
+     * field (see GenericField::withStorage()).
+     */
+    explicit ValueInitializer(const Atom &storage);
+
     /** Constructs a ValueInitializer from an previously-defined importer
      *
      * This should coincide with a Block.
@@ -123,15 +148,69 @@ public:
      */
     ValueInitializer(std::initializer_list<ValueInitializer> list);
 
+    /** @returns whether the initializer holds a single atomic value (e.g. "1" or 2.5), as opposed
+     * to an importer or a list
+     */
+    bool isAtom() const { return mRoot.kind < Node::Kind::Importer; }
+
     std::unique_ptr<GenericFieldValue> import(const GenericField &field,
                                               const std::string &path) override;
     void onEnterBlock(const std::string &block) override;
     void onExitBlock(const std::string &block) override;
 
 private:
-    // This class needs to be copiable because instances will be copied from initializer_list to
-    // list when they are part of a ListImporter. (Copied and not moved because items of a
-    // initializer_list can't be moved). That's why we use a shared_ptr.
-    std::shared_ptr<ValueImporter> mImporter;
+    /** An item of the flattened tree */
+    struct Node
+    {
+        // Atoms first: see isAtom()
+        enum class Kind : uint8_t
+        {
+            Text,
+            String,
+            Boolean,
+            Signed,
+            Unsigned,
+            Floating,
+            Storage,
+            Importer,
+            List
+        };
+
+        Kind kind = Kind::List;
+        /** Lists: the index of the node following their last item; strings and storages: their
+         * index in the corresponding table of the Data
+         */
+        uint32_t index = 0;
+        union
+        {
+            const char *text = nullptr;
+            bool boolean;
+            long long sgn;
+            unsigned long long uns;
+            double floating;
+            ValueImporter *importer;
+        };
+    };
+    /** The flattened tree, shared by copies (lists start at node 0) */
+    struct Data;
+    /** A list being imported */
+    struct Frame
+    {
+        uint32_t next;
+        uint32_t end;
+    };
+
+    /** Appends the nodes (and strings) of the initializer to the data of a list */
+    void appendTo(Data &data) const;
+    std::unique_ptr<GenericFieldValue> importAtom(const Node &node, const GenericField &field,
+                                                  const std::string &path) const;
+
+    Node mRoot;
+    std::shared_ptr<const Data> mData;
+
+    // Import state
+    std::vector<Frame> mFrames;
+    ValueImporter *mDelegate = nullptr;
+    size_t mDelegateDepth = 0;
 };
 }
@@ -29,6 +29,7 @@
 #include "structure/type/detail/stock.fw.hpp"
 #include "structure/structure_export.h"
 
+#include <cstddef>
 #include <string>
 #include <stdexcept>
 
@@ -41,6 +42,8 @@ class BlockValue;
 class GenericFieldValue;
 template <typename T>
 class FieldValue;
+template <size_t Capacity>
+class InlineString;
 
 /** @defgroup Visitors Visitors
  *
@@ -73,6 +76,13 @@ public:
     virtual void visit(const String &s);
     /** Defaults to visit(const GenericField &) */
     virtual void visit(const Bool &s);
+
+    /** Defaults to visit(const Block &) */
+    virtual void visit(const Array &a);
+    /** Defaults to visit(const Block &) */
+    virtual void visit(const VarArray &a);
+    /** Defaults to visit(const Block &) */
+    virtual void visit(const GenericPrefixedArray &a);
 };
 
 /** @example parameter-framework/exportValue.cpp
@@ -127,6 +137,19 @@ public:
     virtual void visitStorage(bool) { unsupported(); }
 
     virtual void visitStorage(const std::string &) { unsupported(); }
+    /** Visits a string which is not held in an std::string (see InlineString)
+     *
+     * Defaults to visitStorage(const std::string &).
+     */
+    virtual void visitStorage(const char *chars, size_t size)
+    {
+        visitStorage(std::string(chars, size));
+    }
+    template <size_t Capacity>
+    void visitStorage(const InlineString<Capacity> &v)
+    {
+        visitStorage(v.data(), v.size());
+    }
 
 protected:
     static void unsupported() { throw std::runtime_error("Visiting an unsupported type"); }
@@ -26,47 +26,19 @@
  */
 #pragma once
 
-#include "structure/type/Structure.hpp"
-#include "structure/Visitor.hpp"
+#include <cstddef>
 
-#include <sstream>
-#include <list>
-
-template <typename T>
-struct ExportTraits
+namespace structure
 {
-    static const std::string typeName;
-};
-
-class PfwStructureVisitor : public structure::StructureVisitor
+namespace attributes
 {
-public:
-    void visit(const structure::Block &block) override;
-    void visit(const structure::GenericField &field) override;
-    void visit(const structure::Integer &i) override;
-    void visit(const structure::FloatingPoint &f) override;
-    void visit(const structure::FixedQ &i) override;
-
-    std::list<std::string> mInstances, mComponents;
-
-private:
-    bool isRoot() { return mLevel == 1; }
-    std::ostringstream mCurrent;
-    int mLevel{1};
-};
-
-std::string exportStructure(const structure::Structure &structure);
-
-class PfwValueVisitor : public structure::ValueVisitor
+/** The alignment, in bytes, of a structure's values in aligned binary layouts
+ *
+ * It must be a power of two. See LayoutPolicy.
+ */
+struct Alignment
 {
-public:
-    void visit(const structure::BlockValue &block) override;
-    void visit(const structure::GenericFieldValue &field) override;
-
-    std::ostringstream mResult;
-
-private:
-    int mLevel{0};
+    size_t mValue;
 };
-
-std::string exportValue(const structure::StructureValue &value);
+}
+}
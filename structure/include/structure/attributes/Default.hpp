@@ -35,15 +35,21 @@ namespace attributes
 
 /** Holds a ValueImporter that can be used by the DefaultImporter to create the Value
  * It acts as a default value.
+ *
+ * Atomic defaults (e.g. `Default{42}`) are constant: fields only convert them once.
  */
 struct Default
 {
     /**
      * @param[in]  value  The value or importer to be used as default value
      */
-    Default(const ValueInitializer &value) : mDefaultImporter(new ValueInitializer(value)) {}
+    Default(const ValueInitializer &value)
+        : mDefaultImporter(new ValueInitializer(value)), mIsConstant(value.isAtom())
+    {
+    }
 
     std::shared_ptr<ValueImporter> mDefaultImporter;
+    bool mIsConstant;
 };
 }
 }
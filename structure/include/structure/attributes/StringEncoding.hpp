@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstddef>
+
+namespace structure
+{
+namespace attributes
+{
+/** How the values of a String field are laid out in binary exports
+ *
+ * Usage example:
+ * @code
+ * String name("name", attributes::StringEncoding::prefixed(2));
+ * @endcode
+ */
+struct StringEncoding
+{
+    enum class Kind
+    {
+        /** The characters followed by a NUL character; finding the end requires a scan */
+        NulTerminated,
+        /** The number of characters as an unsigned LEB128 varint, followed by the characters */
+        Varint,
+        /** The number of characters as an unsigned integer of `mSize` bytes (1, 2, 4 or 8),
+         * followed by the characters */
+        Prefixed,
+        /** Exactly `mSize` bytes: the characters, padded with NUL characters; strings longer than
+         * that are not allowed */
+        FixedCapacity
+    };
+
+    static StringEncoding nulTerminated() { return {Kind::NulTerminated, 0}; }
+    static StringEncoding varint() { return {Kind::Varint, 0}; }
+    static StringEncoding prefixed(size_t width) { return {Kind::Prefixed, width}; }
+    static StringEncoding fixedCapacity(size_t capacity) { return {Kind::FixedCapacity, capacity}; }
+
+    Kind mKind;
+    size_t mSize;
+};
+}
+}
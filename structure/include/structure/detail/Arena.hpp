@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace structure
+{
+namespace detail
+{
+/** A monotonic memory pool for the nodes of a value tree
+ *
+ * Memory is carved out of chunks: building a tree takes one allocation per chunk instead of one or
+ * two per node. A chunk is released when the last node allocated in it is destroyed. Chunk sizes
+ * grow geometrically from 1 KiB up to maxChunkSize, so no size estimate is needed. This also bounds
+ * the memory kept alive by a node outliving the rest of its tree, e.g. a subtree shared with
+ * another value (see BlockValue::addShared()). Arenas are held by shared pointers; see
+ * makeShared().
+ *
+ * Allocating is not thread-safe.
+ */
+class Arena
+{
+public:
+    /** The largest size of chunks, unless a single node is larger */
+    static constexpr size_t maxChunkSize = 64 * 1024;
+
+    /** A contiguous block of memory, shared by the nodes allocated in it */
+    class Chunk
+    {
+    public:
+        explicit Chunk(size_t size)
+            : mMemory(new char[size]), mCurrent(mMemory.get()), mEnd(mCurrent + size)
+        {
+        }
+        Chunk(const Chunk &) = delete;
+        Chunk &operator=(const Chunk &) = delete;
+
+        size_t capacity() const { return size_t(mEnd - mMemory.get()); }
+
+        bool fits(size_t size, size_t alignment) const
+        {
+            return padding(alignment) + size <= size_t(mEnd - mCurrent);
+        }
+
+        void *allocate(size_t size, size_t alignment)
+        {
+            if (not fits(size, alignment)) {
+                // Larger than announced to Arena::reserve(): the allocation gets its own memory,
+                // released along with the chunk.
+                mOverflow.emplace_back(new char[size + alignment]);
+                auto address = reinterpret_cast<uintptr_t>(mOverflow.back().get());
+                return mOverflow.back().get() + (alignment - address % alignment) % alignment;
+            }
+            auto result = mCurrent + padding(alignment);
+            mCurrent = result + size;
+            return result;
+        }
+
+    private:
+        size_t padding(size_t alignment) const
+        {
+            auto address = reinterpret_cast<uintptr_t>(mCurrent);
+            return (alignment - address % alignment) % alignment;
+        }
+
+        std::unique_ptr<char[]> mMemory;
+        char *mCurrent;
+        char *mEnd;
+        std::vector<std::unique_ptr<char[]>> mOverflow;
+    };
+
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /** @returns a chunk with room for an allocation of the given size and alignment */
+    std::shared_ptr<Chunk> reserve(size_t size, size_t alignment)
+    {
+        if (mChunk == nullptr or not mChunk->fits(size, alignment)) {
+            mChunk = std::make_shared<Chunk>(std::max(mNextChunkSize, size + alignment));
+            // Copied, so that the constant is not odr-used
+            mNextChunkSize = std::min(mNextChunkSize * 2, size_t{maxChunkSize});
+        }
+        return mChunk;
+    }
+
+private:
+    static constexpr size_t minChunkSize = 1024;
+
+    std::shared_ptr<Chunk> mChunk;
+    size_t mNextChunkSize = minChunkSize;
+};
+
+/** A standard allocator taking its memory from a chunk of an Arena, which it keeps alive */
+template <class T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(std::shared_ptr<Arena::Chunk> chunk) : mChunk(std::move(chunk)) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : mChunk(other.mChunk)
+    {
+    }
+
+    T *allocate(size_t count)
+    {
+        return static_cast<T *>(mChunk->allocate(count * sizeof(T), alignof(T)));
+    }
+    /** Memory is only released along with the chunk */
+    void deallocate(T *, size_t) {}
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U> &other) const
+    {
+        return mChunk == other.mChunk;
+    }
+    template <class U>
+    bool operator!=(const ArenaAllocator<U> &other) const
+    {
+        return mChunk != other.mChunk;
+    }
+
+private:
+    template <class U>
+    friend class ArenaAllocator;
+
+    std::shared_ptr<Arena::Chunk> mChunk;
+};
+
+/** Constructs an object in an arena
+ *
+ * The object and its reference count share a single allocation; the chunk holding them lives at
+ * least as long as the object.
+ */
+template <class T, class... Args>
+std::shared_ptr<T> makeShared(const std::shared_ptr<Arena> &arena, Args &&... args)
+{
+    // std::allocate_shared() adds a reference count, a virtual table and the allocator to the
+    // object. This is an upper bound on common platforms; Chunk::allocate() copes with larger ones.
+    constexpr size_t controlBlockSize = 8 * sizeof(void *);
+    auto chunk = arena->reserve(sizeof(T) + controlBlockSize, alignof(std::max_align_t));
+    return std::allocate_shared<T>(ArenaAllocator<T>(std::move(chunk)),
+                                   std::forward<Args>(args)...);
+}
+} // namespace detail
+} // namespace structure
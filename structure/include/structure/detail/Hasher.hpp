@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace structure
+{
+namespace detail
+{
+/** Computes a 64-bit FNV-1a hash
+ *
+ * Unlike std::hash, the result only depends on the hashed values: it is the same across processes,
+ * platforms and library versions. Arithmetic values are hashed according to their value rather
+ * than their in-memory representation (integers are widened to 64 bits and hashed little-endian;
+ * floating point numbers are decomposed into their sign, mantissa and exponent).
+ */
+class Hasher
+{
+public:
+    Hasher() = default;
+    /** @param[out] record Where to append everything that is hashed, for exact comparisons */
+    explicit Hasher(std::string &record) : mRecord(&record) {}
+
+    /** Hash raw bytes */
+    void add(const void *data, size_t size)
+    {
+        auto bytes = static_cast<const unsigned char *>(data);
+        if (mRecord != nullptr) {
+            mRecord->append(static_cast<const char *>(data), size);
+        }
+        for (size_t i = 0; i < size; ++i) {
+            mHash = (mHash ^ bytes[i]) * prime;
+        }
+    }
+
+    /** Hash a string
+     *
+     * The size is hashed as well so that ("ab", "c") and ("a", "bc") produce different hashes.
+     */
+    void add(const std::string &value)
+    {
+        add(uint64_t{value.size()});
+        add(value.data(), value.size());
+    }
+
+    /** Hash a boolean */
+    void add(bool value) { add(uint64_t{value ? 1u : 0u}); }
+
+    /** Hash an integer */
+    template <class T>
+    typename std::enable_if<std::is_integral<T>::value>::type add(T value)
+    {
+        auto widened = static_cast<uint64_t>(value);
+        unsigned char bytes[sizeof(widened)];
+        for (auto &byte : bytes) {
+            byte = static_cast<unsigned char>(widened & 0xff);
+            widened >>= 8;
+        }
+        add(bytes, sizeof(bytes));
+    }
+
+    /** Hash a floating point number
+     *
+     * Zeros compare equal regardless of their sign, so they are hashed identically.
+     */
+    template <class T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type add(T value)
+    {
+        if (std::isnan(value)) {
+            add(uint64_t{0xff});
+            return;
+        }
+        if (value == 0) {
+            add(uint64_t{0});
+            return;
+        }
+        int exponent = 0;
+        long double mantissa = std::frexp(static_cast<long double>(value), &exponent);
+        add(uint64_t{mantissa < 0 ? 2u : 1u});
+        add(static_cast<uint64_t>(std::ldexp(std::fabs(mantissa), 64)));
+        add(int64_t{exponent});
+    }
+
+    uint64_t get() const { return mHash; }
+
+private:
+    static constexpr uint64_t prime = 0x100000001b3;
+    uint64_t mHash = 0xcbf29ce484222325;
+    std::string *mRecord = nullptr;
+};
+
+/** Lazily computed hash which can be read and written concurrently
+ *
+ * Copies carry the cached value along.
+ */
+class HashCache
+{
+public:
+    HashCache() = default;
+    HashCache(const HashCache &other) : mValue(other.mValue.load(std::memory_order_relaxed)) {}
+    HashCache &operator=(const HashCache &other)
+    {
+        mValue.store(other.mValue.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    /** @returns the cached value, computing it with `compute()` if needed */
+    template <class Compute>
+    uint64_t get(Compute compute) const
+    {
+        auto value = mValue.load(std::memory_order_relaxed);
+        if (value == empty) {
+            value = compute();
+            // Reserve "empty" to mean that the value hasn't been computed yet.
+            value = value == empty ? empty + 1 : value;
+            mValue.store(value, std::memory_order_relaxed);
+        }
+        return value;
+    }
+
+    /** Forget the cached value */
+    void reset() { mValue.store(empty, std::memory_order_relaxed); }
+
+private:
+    static constexpr uint64_t empty = 0;
+    mutable std::atomic<uint64_t> mValue{empty};
+};
+} // namespace detail
+} // namespace structure
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace structure
+{
+namespace detail
+{
+/** @returns the number of jobs to be used when the user did not specify one */
+inline unsigned defaultJobs()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/** Splits [0, count) in contiguous ranges and processes them concurrently
+ *
+ * The first range is processed by the calling thread. Exceptions thrown by any of the jobs are
+ * propagated to the caller (the first one, in range order).
+ *
+ * @param[in] count The number of items to process
+ * @param[in] jobs The maximum number of concurrent jobs
+ * @param[in] function Called as `function(job, begin, end)` for each range; `job` is in
+ *                     [0, number of ranges).
+ * @returns the number of ranges that have been processed
+ */
+template <class Function>
+size_t parallelFor(size_t count, unsigned jobs, Function function)
+{
+    size_t ranges = std::min<size_t>(std::max(1u, jobs), count);
+    if (ranges <= 1) {
+        function(size_t{0}, size_t{0}, count);
+        return 1;
+    }
+
+    auto rangeBegin = [&](size_t job) { return count * job / ranges; };
+
+    std::vector<std::future<void>> workers;
+    workers.reserve(ranges - 1);
+    for (size_t job = 1; job < ranges; ++job) {
+        workers.push_back(std::async(std::launch::async, [&, job] {
+            function(job, rangeBegin(job), rangeBegin(job + 1));
+        }));
+    }
+
+    // Wait for all the workers before rethrowing: they reference our stack.
+    std::exception_ptr error;
+    try {
+        function(size_t{0}, size_t{0}, rangeBegin(1));
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (auto &worker : workers) {
+        try {
+            worker.get();
+        } catch (...) {
+            if (not error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return ranges;
+}
+} // namespace detail
+} // namespace structure
@@ -39,6 +39,7 @@
 #include <memory>
 #include <functional>
 #include <ostream>
+#include <vector>
 
 namespace structure
 {
@@ -94,6 +95,19 @@ STRUCTURE_EXPORT void apply(const StructureValue &structure, BlockValueFunction
                             BlockValueFunction onExitBlock, FieldValueFunction onEnterField,
                             bool recursive);
 
+/** Lightweight implementation of a ValueVisitor only browsing modified values
+ *
+ * Same as a recursive structure::apply() except that values that are not dirty (see
+ * StructureValue::isDirty()) are skipped, along with all their children.
+ *
+ * @param[in] structure The value to be visited
+ * @param[in] onEnterBlock Function to be called at the beggining of a dirty BlockValue
+ * @param[in] onExitBlock Function to be called at the end of a dirty BlockValue
+ * @param[in] onEnterField Function to be called on a dirty FieldValue
+ */
+STRUCTURE_EXPORT void applyDirty(const StructureValue &structure, BlockValueFunction onEnterBlock,
+                                 BlockValueFunction onExitBlock, FieldValueFunction onEnterField);
+
 // Functions
 /** Pretty-print a Structure
  *
@@ -111,6 +125,30 @@ STRUCTURE_EXPORT void print(std::ostream &outStream, const std::unique_ptr<Block
 STRUCTURE_EXPORT void print(std::ostream &outStream, const StructureValue &value);
 /** See the structure::print(std::ostream&, const StructureValue&) overload. */
 STRUCTURE_EXPORT void print(std::ostream &outStream, const std::unique_ptr<StructureValue> &value);
+/** Pretty-print a StructureValue using several threads
+ *
+ * The top-level children of the value are printed concurrently in per-thread buffers which are
+ * then written in order. The output is identical to the one of the single-threaded overload.
+ *
+ * @param[out] outStream The stream on which to print
+ * @param[in] value The value to be printed
+ * @param[in] jobs The maximum number of threads to be used
+ */
+STRUCTURE_EXPORT void print(std::ostream &outStream, const StructureValue &value, unsigned jobs);
+
+/** Split a value into consecutive chunks at Block boundaries
+ *
+ * BlockValues are replaced by their children, one level at a time, until there are at least
+ * `minChunks` chunks or there is no BlockValue left to split. Visiting the fields of each chunk, in
+ * order, is equivalent to visiting the fields of the whole value; this is meant for dispatching
+ * the export of a large value on several threads.
+ *
+ * @param[in] value The value to be split
+ * @param[in] minChunks The number of chunks under which blocks are split further
+ * @returns the chunks, in order
+ */
+STRUCTURE_EXPORT std::vector<std::reference_wrapper<const StructureValue>> split(
+    const StructureValue &value, size_t minChunks);
 
 /** @defgroup FunctionalEquivalents Pure-function equivalent of methods
  *
@@ -58,4 +58,12 @@ public:
 private:
     T mValue;
 };
+
+/** Imports atoms as the in-memory values of fields; see GenericField::withStorage() */
+template <>
+inline std::unique_ptr<GenericFieldValue> AtomImporter<Atom>::import(const GenericField &field,
+                                                                      const std::string &)
+{
+    return field.withStorage(mValue);
+}
 }
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/ValueImporter.hpp"
+#include "structure/type/GenericField.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace structure
+{
+
+/** An implementation of a ValueImporter that gets its values from text in memory
+ *
+ * It reads the same format as a StreamImporter over std::istream: values are separated by
+ * whitespace and may be quoted, with the rules of `std::quoted` (a backslash escapes the next
+ * character). However, it scans the text directly instead of going through iostreams: no sentry,
+ * no locale and no allocation once the longest value has been seen. This is meant for bulk
+ * imports, e.g. from a memory-mapped file.
+ *
+ * Unlike a StreamImporter, it throws NotEnoughValues at the end of the text, so that
+ * variable-length arrays consume all the remaining values.
+ *
+ * @ingroup ValueImporter
+ */
+class BufferImporter : public ValueImporter
+{
+public:
+    /**
+     * @param[in] data The text, which must outlive the importer; it need not be NUL-terminated
+     * @param[in] size The size of the text, in bytes
+     */
+    BufferImporter(const char *data, size_t size) : mBegin(data), mCurrent(data), mEnd(data + size)
+    {
+    }
+    /** @param[in] text The text, which must outlive the importer */
+    explicit BufferImporter(const std::string &text) : BufferImporter(text.data(), text.size()) {}
+    /** Temporary strings would be destroyed before the importer reads them */
+    BufferImporter(std::string &&) = delete;
+    /** @param[in] text The NUL-terminated text (e.g. a literal), which must outlive the importer */
+    explicit BufferImporter(const char *text) : BufferImporter(text, std::strlen(text)) {}
+
+    std::unique_ptr<GenericFieldValue> import(const GenericField &f,
+                                              const std::string & /*path*/) override
+    {
+        if (not next()) {
+            throw NotEnoughValues(f.getName());
+        }
+        return f.with(mToken);
+    }
+
+    /** @returns the number of bytes read so far */
+    size_t getPosition() const { return size_t(mCurrent - mBegin); }
+
+private:
+    /** Same as std::isspace in the "C" locale */
+    static bool isSpace(char c) { return c == ' ' or (c >= '\t' and c <= '\r'); }
+
+    /** Reads the next value into mToken
+     *
+     * @returns false at the end of the text
+     */
+    bool next()
+    {
+        while (mCurrent != mEnd and isSpace(*mCurrent)) {
+            ++mCurrent;
+        }
+        if (mCurrent == mEnd) {
+            return false;
+        }
+
+        if (*mCurrent != '"') {
+            auto begin = mCurrent;
+            while (mCurrent != mEnd and not isSpace(*mCurrent)) {
+                ++mCurrent;
+            }
+            mToken.assign(begin, mCurrent);
+            return true;
+        }
+
+        // Quoted values end at the first unescaped quote (or at the end of the text).
+        ++mCurrent;
+        mToken.clear();
+        while (mCurrent != mEnd) {
+            auto run = mCurrent;
+            while (mCurrent != mEnd and *mCurrent != '"' and *mCurrent != '\\') {
+                ++mCurrent;
+            }
+            mToken.append(run, mCurrent);
+            if (mCurrent == mEnd) {
+                break;
+            }
+            if (*mCurrent++ == '"') {
+                break;
+            }
+            // A backslash: take the next character as is
+            if (mCurrent != mEnd) {
+                mToken.push_back(*mCurrent++);
+            }
+        }
+        return true;
+    }
+
+    const char *mBegin;
+    const char *mCurrent;
+    const char *mEnd;
+    /** Reused from one value to the next: fields parse std::strings */
+    std::string mToken;
+};
+} // namespace structure
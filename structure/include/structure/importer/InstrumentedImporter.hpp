@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/ValueImporter.hpp"
+#include "structure/type/GenericField.hpp"
+#include "structure/value/GenericFieldValue.hpp"
+#include "structure/Exception.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace structure
+{
+
+/** What an InstrumentedImporter has seen of the values it helped building */
+struct BuildStatistics
+{
+    struct Counters
+    {
+        /** The number of field values created */
+        size_t values = 0;
+        /** The number of fields which failed to be imported (i.e. the importer threw)
+         *
+         * Running out of values at the end of a VarArray is how VarArrays end: it is not a failure.
+         */
+        size_t failures = 0;
+        /** The time spent */
+        std::chrono::nanoseconds time{0};
+    };
+
+    /** Per type of field (see Structure::getTypeName()): the time spent importing them */
+    std::map<std::string, Counters> fieldTypes;
+    /** Per block path: the time spent building the complete blocks, children included
+     *
+     * Blocks which appear several times (e.g. array items, or several builds) are accumulated.
+     * Blocks whose build was abandoned (e.g. the incomplete item ending a VarArray) are not
+     * accounted for, their values are accounted to their parents.
+     */
+    std::map<std::string, Counters> blocks;
+    /** The number of blocks built */
+    size_t blockCount = 0;
+
+    /** @returns the sum of all the fieldTypes counters */
+    Counters total() const
+    {
+        Counters sum;
+        for (const auto &type : fieldTypes) {
+            sum.values += type.second.values;
+            sum.failures += type.second.failures;
+            sum.time += type.second.time;
+        }
+        return sum;
+    }
+};
+
+/** Instruments another importer, to see where the time goes when building values
+ *
+ * This is opt-in: builds which don't go through an InstrumentedImporter are not instrumented at
+ * all. It is meant for diagnosing slow imports, as measuring adds its own overhead (reading a
+ * clock twice per field and per block).
+ *
+ * @code
+ * StreamImporter<> input(stream);
+ * InstrumentedImporter importer(input);
+ * auto value = root.build(importer);
+ * auto slowest = importer.getStatistics().blocks;
+ * @endcode
+ *
+ * It is not thread-safe: use one per concurrent build.
+ *
+ * @ingroup ValueImporter
+ */
+class InstrumentedImporter : public ValueImporter
+{
+public:
+    /** @param[in] importer The importer to be instrumented; it must outlive this one */
+    InstrumentedImporter(ValueImporter &importer) : mImporter(importer) {}
+
+    std::unique_ptr<GenericFieldValue> import(const GenericField &field,
+                                              const std::string &path) override
+    {
+        auto &counters = countersOf(field);
+        auto start = Clock::now();
+        mExhausted = nullptr;
+        try {
+            auto value = mImporter.import(field, path);
+            counters.time += Clock::now() - start;
+            ++counters.values;
+            ++mValues;
+            return value;
+        } catch (NotEnoughValues &) {
+            // A failure, unless a VarArray catches it (see onExitBlock())
+            counters.time += Clock::now() - start;
+            ++counters.failures;
+            ++mFailures;
+            mExhausted = &counters;
+            throw;
+        } catch (...) {
+            counters.time += Clock::now() - start;
+            ++counters.failures;
+            ++mFailures;
+            throw;
+        }
+    }
+
+    void onEnterBlock(const std::string &block) override
+    {
+        mExhausted = nullptr;
+        mOpenBlocks.push_back({block, Clock::now(), mValues, mFailures});
+        mImporter.onEnterBlock(block);
+    }
+
+    void onExitBlock(const std::string &block) override
+    {
+        mImporter.onExitBlock(block);
+        if (mExhausted != nullptr) {
+            // The input ran out inside a block which has been built nonetheless: a VarArray.
+            --mExhausted->failures;
+            --mFailures;
+            mExhausted = nullptr;
+        }
+
+        // Blocks entered since this one have been abandoned by an exception.
+        auto found = std::find_if(mOpenBlocks.rbegin(), mOpenBlocks.rend(),
+                                  [&](const OpenBlock &open) { return open.path == block; });
+        if (found == mOpenBlocks.rend()) {
+            return;
+        }
+        auto open = std::move(*found);
+        mOpenBlocks.erase(std::prev(found.base()), mOpenBlocks.end());
+
+        ++mStatistics.blockCount;
+        auto &counters = mStatistics.blocks[block];
+        counters.values += mValues - open.values;
+        counters.failures += mFailures - open.failures;
+        counters.time += Clock::now() - open.start;
+    }
+
+    const BuildStatistics &getStatistics() const { return mStatistics; }
+
+    /** Forgets the statistics gathered so far, e.g. between two builds */
+    void reset()
+    {
+        mStatistics = BuildStatistics{};
+        mTypeCounters.clear();
+        mOpenBlocks.clear();
+        mExhausted = nullptr;
+        mValues = 0;
+        mFailures = 0;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct OpenBlock
+    {
+        std::string path;
+        Clock::time_point start;
+        size_t values;
+        size_t failures;
+    };
+
+    /** Fields of the same C++ type have the same type name: only ask for it once per type */
+    BuildStatistics::Counters &countersOf(const GenericField &field)
+    {
+        auto found = mTypeCounters.find(typeid(field));
+        if (found != mTypeCounters.end()) {
+            return *found->second;
+        }
+        auto &counters = mStatistics.fieldTypes[field.getTypeName()];
+        mTypeCounters.emplace(typeid(field), &counters);
+        return counters;
+    }
+
+    ValueImporter &mImporter;
+    BuildStatistics mStatistics;
+    /** Points into mStatistics.fieldTypes, whose elements are stable */
+    std::unordered_map<std::type_index, BuildStatistics::Counters *> mTypeCounters;
+    std::vector<OpenBlock> mOpenBlocks;
+    /** The counters of the last field, if importing it ran out of values; null otherwise */
+    BuildStatistics::Counters *mExhausted = nullptr;
+    size_t mValues = 0;
+    size_t mFailures = 0;
+};
+} // namespace structure
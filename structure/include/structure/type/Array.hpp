@@ -40,7 +40,7 @@ class Array : public Block
 public:
     /** Construct a fixed size Array of any kind of field.
      *
-     * @param[in] itemType The structure that is repeated in the array.
+     * @param[in] itemType The structure that is repeated in the array (or a std::unique_ptr to it).
      * @param[in] size The size of the array (number of elements)
      * @param[in] args Attributes of the Array
      */
@@ -48,12 +48,22 @@ public:
     Array(const std::string &name, ItemType &&itemType, size_t size, Args &&... args)
         : Block(name, std::forward<ItemType>(itemType), std::forward<Args>(args)...), mSize(size)
     {
-        static_assert(is_structure<ItemType>::value,
+        static_assert(is_structure<ItemType>::value or
+                          is_structure_ptr<typename std::decay<ItemType>::type>::value,
                       "The ItemType in a VarArray must be a Structure");
         static_assert(not disjunction<is_structure<Args>...>::value,
                       "The arguments after ItemType must not be Structures");
+        StructureTraits traits;
+        traits.kind = StructureKind::Array;
+        traits.count = size;
+        setTraits(traits);
     }
 
+    void accept(StructureVisitor &visitor) const override { visitor.visit(*this); }
+
+    /** @returns the number of items in the array */
+    size_t getSize() const { return mSize; }
+
     std::string getTypeName() const override
     {
         std::ostringstream ss;
@@ -75,6 +85,32 @@ private:
 
         return std::move(arrayValue);
     }
+    std::unique_ptr<StructureValue> doBuildDefault() const override
+    {
+        auto arrayValue = std::make_unique<BlockValue>(*this);
+        if (mSize == 0) {
+            return arrayValue;
+        }
+        // All the items are the same: build the first one and copy it.
+        auto item = getFields()[0].get().buildDefault();
+        for (size_t i = 1; i < mSize; ++i) {
+            arrayValue->addValue(item->clone());
+        }
+        arrayValue->addValue(std::move(item));
+
+        return arrayValue;
+    }
+    std::shared_ptr<StructureValue> doInstantiate(
+        const StructureValue &prototype,
+        const std::shared_ptr<detail::Arena> &arena) const override
+    {
+        auto arrayValue = detail::makeShared<BlockValue>(arena, *this);
+        const auto &item = getFields()[0].get();
+        for (const auto &child : static_cast<const BlockValue &>(prototype).getFields()) {
+            arrayValue->adoptValue(item.instantiateFrom(*child, arena));
+        }
+        return arrayValue;
+    }
 
     size_t mSize;
 };
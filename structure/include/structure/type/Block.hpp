@@ -50,22 +50,40 @@ public:
      * In the context of this class, "field" may refer to both atomic fields and aggregates
      * (blocks).
      *
-     * @param[in] args The fields to be included in the new block and the block's attributes
+     * @param[in] args The fields to be included in the new block (or std::unique_ptr to them) and
+     *                 the block's attributes
      *
      * Usage exemple:
      * @code
-     * Block myBlock(UInt8("a"), Float("b"), attributes::Description{"desc"});
+     * Block myBlock(UInt8("a"), Float("b"), attributes::Description{"desc"},
+     *               attributes::Alignment{8});
      * @endcode
      *
      */
     template <typename... Args>
     Block(const std::string &name, Args &&... args) : Structure(name)
     {
+        setTraits({StructureKind::Block});
         handleArgs(std::forward<Args>(args)...);
     }
 
-    Block(Block &&other) = default;
-    Block &operator=(Block &&other) = default;
+    Block(Block &&other)
+        : Structure(std::move(other)), mFields(std::move(other.mFields)),
+          mDescription(std::move(other.mDescription)), mAlignment(other.mAlignment)
+    {
+        adoptChildren();
+    }
+    Block &operator=(Block &&other)
+    {
+        Structure::operator=(std::move(other));
+        mFields = std::move(other.mFields);
+        mDescription = std::move(other.mDescription);
+        mAlignment = other.mAlignment;
+        adoptChildren();
+        invalidateFingerprint();
+        invalidateLayout();
+        return *this;
+    }
 
     void accept(StructureVisitor &visitor) const override;
 
@@ -79,10 +97,19 @@ public:
 
     std::string getTypeName() const override { return "Block"; }
     std::string getDescription() const override { return mDescription; }
+    size_t getAlignment() const override { return mAlignment; }
 
-    void addChild(std::unique_ptr<Structure> child) { mFields.emplace_back(std::move(child)); }
+    void addChild(std::unique_ptr<Structure> child)
+    {
+        mFields.emplace_back(std::move(child));
+        adoptChild(*mFields.back());
+        invalidateFingerprint();
+        invalidateLayout();
+    }
 
 protected:
+    void fingerprint(detail::Hasher &hasher) const override;
+
     template <typename T, typename... Fields>
     void handleArgs(T &&first, Fields &&... fields)
     {
@@ -93,17 +120,40 @@ protected:
 private:
     std::unique_ptr<StructureValue> doBuild(ValueImporter &importer,
                                             const std::string &path) const override;
+    std::unique_ptr<StructureValue> doBuildDefault() const override;
+    std::shared_ptr<StructureValue> doInstantiate(
+        const StructureValue &prototype,
+        const std::shared_ptr<detail::Arena> &arena) const override;
 
     void handleArg(const attributes::Description &desc) { mDescription = desc.mValue; }
+    void handleArg(const attributes::Alignment &alignment)
+    {
+        mAlignment = StructureAttributes::checkAlignment(alignment.mValue);
+    }
     template <class T, typename = typename std::enable_if<is_structure<T>::value>::type>
     void handleArg(T &&child)
     {
         mFields.emplace_back(new T(std::forward<T>(child)));
+        adoptChild(*mFields.back());
+    }
+    template <class T, typename = typename std::enable_if<is_structure<T>::value>::type>
+    void handleArg(std::unique_ptr<T> child)
+    {
+        mFields.emplace_back(std::move(child));
+        adoptChild(*mFields.back());
     }
 
     void handleArgs(){};
 
+    void adoptChildren()
+    {
+        for (auto &field : mFields) {
+            adoptChild(*field);
+        }
+    }
+
     std::vector<std::unique_ptr<Structure>> mFields;
     std::string mDescription;
+    size_t mAlignment = 0;
 };
 }
@@ -51,5 +51,6 @@ public:
 
     /** @returns the human-readable name of the field type */
     static std::string typeToString() { return "Bool"; }
+    static StructureTraits traits() { return {StructureKind::Bool}; }
 };
 } // namespace structure
@@ -35,10 +35,57 @@
 
 #include "structure/detail/safe_cast.hpp"
 
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <typeinfo>
+
 namespace structure
 {
 namespace detail
 {
+/** Caches the default storage of a field
+ *
+ * Values hold a copy of their field, which must be cheap to make: copies start with an empty
+ * cache. The storage is thus computed once per field of a schema (rather than per value) and
+ * read without taking any lock.
+ */
+template <class Storage>
+class DefaultCache
+{
+public:
+    DefaultCache() = default;
+    DefaultCache(const DefaultCache &) {}
+    DefaultCache &operator=(const DefaultCache &)
+    {
+        // The assigned field may have another default.
+        delete mStorage.exchange(nullptr);
+        return *this;
+    }
+    ~DefaultCache() { delete mStorage.load(); }
+
+    /** @returns the cached storage, computing it with `compute()` if needed */
+    template <class Compute>
+    const Storage &get(Compute compute) const
+    {
+        auto storage = mStorage.load(std::memory_order_acquire);
+        if (storage == nullptr) {
+            std::unique_ptr<const Storage> computed(new Storage(compute()));
+            // Threads computing it concurrently agree on the first one to be stored.
+            if (mStorage.compare_exchange_strong(storage, computed.get(),
+                                                 std::memory_order_acq_rel)) {
+                storage = computed.release();
+            }
+        }
+        // The storage is never replaced once computed: it lives as long as the cache.
+        return *storage;
+    }
+
+private:
+    mutable std::atomic<const Storage *> mStorage{nullptr};
+};
+
 /** Helper class for implementing new field types.
  *
  * CRTP = Curiously Reccuring Template Pattern.
@@ -61,9 +108,16 @@ public:
     template <typename... Attrs>
     FieldCrtp(const std::string &name, Attrs &&... attributes) : Base(name)
     {
+        this->setTraits(Derived::traits());
         setAttributes(std::forward<Attrs>(attributes)...);
     };
 
+    /** @returns the traits of the field type (see Structure::getTraits())
+     *
+     * Derived classes should hide it; fields are of kind StructureKind::Field otherwise.
+     */
+    static StructureTraits traits() { return {StructureKind::Field}; }
+
     using Storage = _Storage;
 
     void accept(StructureVisitor &visitor) const override
@@ -85,9 +139,25 @@ public:
 
     std::string getTypeName() const override { return Derived::typeToString(); }
     std::string getDescription() const override { return mAttributes.mDescription; }
+    size_t getAlignment() const override { return mAttributes.mAlignment; }
     ValueImporter &getDefaultImporter() const override { return *(mAttributes.mDefaultImporter); }
     bool hasDefaultImporter() const override { return mAttributes.mHasDefaultImporter; }
 
+    std::unique_ptr<GenericFieldValue> withDefault(const std::string &path) const override
+    {
+        if (not mAttributes.mHasDefaultImporter) {
+            throw NoDefaultValue(this->getName());
+        }
+        if (not mAttributes.mHasConstantDefault) {
+            return mAttributes.mDefaultImporter->import(*this, path);
+        }
+        const auto &storage = mDefault.get([&] {
+            auto value = mAttributes.mDefaultImporter->import(*this, path);
+            return value->getStorage().template as<_Storage>();
+        });
+        return std::make_unique<ThisValue>(*static_cast<const Derived *>(this), storage);
+    }
+
     template <typename T>
     std::unique_ptr<GenericFieldValue> withTypedTemplate(T value) const try {
         return std::make_unique<ThisValue>(*static_cast<const Derived *>(this),
@@ -98,8 +168,50 @@ public:
 
     const Attributes &getAttributes() const { return mAttributes; }
 
+    size_t getStorageSize() const override
+    {
+        return std::is_arithmetic<_Storage>::value ? sizeof(_Storage) : 0;
+    }
+    size_t getStorageAlignment() const override
+    {
+        return std::is_arithmetic<_Storage>::value ? alignof(_Storage) : 1;
+    }
+    const std::type_info &getStorageType() const override { return typeid(_Storage); }
+
+    void visitRawStorage(const void *raw, StorageVisitor &visitor) const override
+    {
+        visitor.visitStorage(readRaw(raw, static_cast<_Storage *>(nullptr)));
+    }
+
+    std::unique_ptr<GenericFieldValue> withStorage(const Atom &storage) const override
+    {
+        return std::make_unique<ThisValue>(*static_cast<const Derived *>(this),
+                                           storage.as<_Storage>());
+    }
+
+protected:
+    void fingerprint(detail::Hasher &hasher) const override
+    {
+        Base::fingerprint(hasher);
+        // Logical sizes rather than storage sizes, which depend on the platform (e.g. the padding
+        // of long doubles or the layout of fixed strings).
+        const auto &traits = this->getTraits();
+        hasher.add(static_cast<uint64_t>(traits.kind));
+        hasher.add(traits.isSigned);
+        if (traits.kind == StructureKind::FloatingPoint) {
+            using Limits = std::numeric_limits<_Storage>;
+            hasher.add(static_cast<uint64_t>(Limits::digits));
+            hasher.add(static_cast<uint64_t>(Limits::max_exponent));
+        } else {
+            hasher.add(traits.size);
+        }
+        hasher.add(traits.fractional);
+        mAttributes.fingerprint(hasher);
+    }
+
 private:
     Attributes mAttributes;
+    DefaultCache<_Storage> mDefault;
 
     template <typename Head, typename... Tail>
     void setAttributes(Head &&head, Tail &&... tail)
@@ -109,11 +221,37 @@ private:
     }
     void setAttributes() {}
 
+    template <class T>
+    static T readRaw(const void *raw, T *)
+    {
+        T value;
+        std::memcpy(&value, raw, sizeof(value));
+        return value;
+    }
+    static std::string readRaw(const void *raw, std::string *)
+    {
+        return static_cast<const char *>(raw);
+    }
+
     std::unique_ptr<StructureValue> doBuild(ValueImporter &importer,
                                             const std::string &path) const override
     {
         return importer.import(*this, path);
     }
+    std::unique_ptr<StructureValue> doBuildDefault() const override
+    {
+        return withDefault(this->getName());
+    }
+    std::shared_ptr<StructureValue> doInstantiate(
+        const StructureValue &prototype, const std::shared_ptr<Arena> &arena) const override
+    {
+        if (typeid(prototype) == typeid(ThisValue)) {
+            return makeShared<ThisValue>(arena, *static_cast<const Derived *>(this),
+                                         static_cast<const ThisValue &>(prototype).getTypedValue());
+        }
+        // The prototype was built from another (equal) field type
+        return withStorage(static_cast<const GenericFieldValue &>(prototype).getStorage());
+    }
 };
 } // namespace detail
 }
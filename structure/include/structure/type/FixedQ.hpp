@@ -119,6 +119,11 @@ public:
     size_t getIntegral() const override { return size - fractional - (isSigned ? 1 : 0); }
     bool getSignedness() const override { return isSigned; }
 
+    static StructureTraits traits()
+    {
+        return {StructureKind::FixedQ, isSigned, size, fractional};
+    }
+
     /** Parse a decimal number into a FixedQ
      *
      * @param[in] input A string representing a decimal number (e.g. "1.125").
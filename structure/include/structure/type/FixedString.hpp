@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/type/Field.hpp"
+#include "structure/attributes/MaxLength.hpp"
+#include "structure/attributes/StringEncoding.hpp"
+#include "structure/value/InlineString.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace structure
+{
+struct FixedStringAttributes : GenericFieldAttributes
+{
+    void set(const attributes::MaxLength &maxLength) { mMaxLength = maxLength.mValue; }
+    template <typename C>
+    void set(const C &c)
+    {
+        GenericFieldAttributes::set(c);
+    }
+
+    void fingerprint(detail::Hasher &hasher) const
+    {
+        GenericFieldAttributes::fingerprint(hasher);
+        hasher.add(mMaxLength);
+    }
+
+    size_t mMaxLength = std::numeric_limits<size_t>::max();
+};
+
+/** A type of field containing a string of at most `Capacity` characters
+ *
+ * Unlike String, values are stored inline (see InlineString) and binary exports lay them out on
+ * exactly `Capacity` bytes, padded with NUL characters (see attributes::StringEncoding), so that
+ * blocks containing them may have a fixed size.
+ *
+ * Usage example:
+ * @code
+ * Block device(UInt16("id"), FixedString<16>("name", attributes::MaxLength{12}));
+ * @endcode
+ */
+template <size_t Capacity>
+class FixedString
+    : public detail::FieldCrtp<FixedString<Capacity>, GenericField, InlineString<Capacity>,
+                               FixedStringAttributes>
+{
+private:
+    using Base = detail::FieldCrtp<FixedString<Capacity>, GenericField, InlineString<Capacity>,
+                                   FixedStringAttributes>;
+
+public:
+    using Base::Base;
+
+    attributes::StringEncoding getStringEncoding() const override
+    {
+        return attributes::StringEncoding::fixedCapacity(Capacity);
+    }
+
+    /** @returns the maximum number of characters of values */
+    size_t getMaxLength() const { return std::min(Capacity, this->getAttributes().mMaxLength); }
+
+    bool isAllowed(const InlineString<Capacity> &value) const
+    {
+        return value.size() <= getMaxLength();
+    }
+
+    /** @returns A parsed value.
+     *
+     * @throws ParseError if the input has more than `Capacity` characters.
+     */
+    static InlineString<Capacity> fromString(const std::string &input) try {
+        return input;
+    } catch (std::length_error &e) {
+        throw ParseError(e.what());
+    }
+
+    /** Reads a NUL-terminated string, or exactly `Capacity` characters */
+    void visitRawStorage(const void *raw, StorageVisitor &visitor) const override
+    {
+        auto chars = static_cast<const char *>(raw);
+        auto end = static_cast<const char *>(std::memchr(chars, '\0', Capacity));
+        visitor.visitStorage(chars, end == nullptr ? Capacity : static_cast<size_t>(end - chars));
+    }
+
+    /** @returns the human-readable name of the field type */
+    static std::string typeToString() { return "FixedString" + std::to_string(Capacity); }
+    static StructureTraits traits() { return {StructureKind::FixedString, false, Capacity}; }
+};
+} // namespace structure
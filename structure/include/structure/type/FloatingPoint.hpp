@@ -108,6 +108,11 @@ public:
 
     /** @returns the human-readable name of the field type */
     static std::string typeToString() { return detail::FloatingTrait<_Storage>::getName(); }
+
+    static StructureTraits traits()
+    {
+        return {StructureKind::FloatingPoint, true, sizeof(_Storage) * 8};
+    }
 };
 
 /** @addtogroup StockTypes
@@ -32,6 +32,9 @@
 #include "structure/Exception.hpp"
 #include "structure/value/GenericFieldValue.hpp"
 #include "structure/attributes/Default.hpp"
+#include "structure/attributes/StringEncoding.hpp"
+
+#include <typeinfo>
 
 namespace structure
 {
@@ -42,6 +45,7 @@ struct STRUCTURE_EXPORT GenericFieldAttributes : StructureAttributes
     {
         mDefaultImporter = def.mDefaultImporter;
         mHasDefaultImporter = true;
+        mHasConstantDefault = def.mIsConstant;
     }
 
     template <typename C>
@@ -51,6 +55,7 @@ struct STRUCTURE_EXPORT GenericFieldAttributes : StructureAttributes
     }
 
     bool mHasDefaultImporter = false;
+    bool mHasConstantDefault = false;
     std::shared_ptr<ValueImporter> mDefaultImporter;
 };
 
@@ -78,6 +83,49 @@ public:
     virtual ValueImporter &getDefaultImporter() const = 0;
     virtual bool hasDefaultImporter() const = 0;
 
+    /** Creates a value from the field's Default attribute
+     *
+     * Constant defaults are converted into the field's storage on the first call, which is cached
+     * by the field (but not by its copies); the next calls neither parse nor import anything.
+     * Other defaults (e.g. importers) are imported on each call.
+     *
+     * @param[in] path The path of the field, for defaults which are importers
+     * @throws NoDefaultValue if the field does not have a Default attribute
+     */
+    virtual std::unique_ptr<GenericFieldValue> withDefault(const std::string &path) const = 0;
+
+    /** @returns the size of the in-memory storage of the field's values, or 0 if it varies (e.g.
+     * for strings)
+     */
+    virtual size_t getStorageSize() const = 0;
+    /** @returns the natural alignment of the in-memory storage of the field's values (1 for
+     * strings)
+     */
+    virtual size_t getStorageAlignment() const = 0;
+    /** @returns how the field's values are laid out in binary exports, if they are strings */
+    virtual attributes::StringEncoding getStringEncoding() const
+    {
+        return attributes::StringEncoding::nulTerminated();
+    }
+    /** @returns the type of the in-memory storage of the field's values */
+    virtual const std::type_info &getStorageType() const = 0;
+
+    /** Visits a storage of the field's type held in raw memory
+     *
+     * @param[in] raw The object representation of the storage (i.e. as copied by memcpy) or, for
+     *                strings, a NUL-terminated string; this is the way binary_export lays out
+     *                fields by default. It does not need to be aligned.
+     * @param[in] visitor The visitor, called with the exact storage type
+     */
+    virtual void visitRawStorage(const void *raw, StorageVisitor &visitor) const = 0;
+
+    /** Creates a value from its in-memory storage
+     *
+     * @throws ParseError if the storage can't be converted to the field's storage type
+     * @throws std::range_error if the value is not allowed by the field (e.g. out of range)
+     */
+    virtual std::unique_ptr<GenericFieldValue> withStorage(const Atom &storage) const = 0;
+
 private:
     /** Creates a value from the given bool
      */
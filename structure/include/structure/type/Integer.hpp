@@ -90,6 +90,8 @@ public:
     size_t getSize() const override { return size; }
     bool getSignedness() const override { return isSigned; }
 
+    static StructureTraits traits() { return {StructureKind::Integer, isSigned, size}; }
+
     bool isAllowed(const _Storage &value) const
     {
         auto &range = this->getAttributes().mRange;
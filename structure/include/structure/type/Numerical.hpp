@@ -47,5 +47,12 @@ public:
     {
         GenericFieldAttributes::set(c);
     }
+
+    void fingerprint(detail::Hasher &hasher) const
+    {
+        GenericFieldAttributes::fingerprint(hasher);
+        hasher.add(mRange.min());
+        hasher.add(mRange.max());
+    }
 };
 } // namespace structure
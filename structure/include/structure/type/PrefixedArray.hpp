@@ -29,6 +29,7 @@
 #include "structure/type/Block.hpp"
 #include "structure/Exception.hpp"
 #include "structure/functions.hpp"
+#include "structure/value/FieldValue.hpp"
 #include "structure/detail/disjunction.hpp"
 
 #include "structure/detail/safe_cast.hpp"
@@ -36,6 +37,26 @@
 
 namespace structure
 {
+/** The non-template part of PrefixedArray
+ *
+ * It allows handling all prefixed arrays regardless of the type of their prefix.
+ */
+class GenericPrefixedArray : public Block
+{
+public:
+    template <typename... Args>
+    GenericPrefixedArray(const std::string &name, Args &&... args)
+        : Block(name, std::forward<Args>(args)...)
+    {
+        setTraits({StructureKind::PrefixedArray});
+    }
+
+    void accept(StructureVisitor &visitor) const override { visitor.visit(*this); }
+
+    /** @returns the field holding the number of items */
+    virtual const GenericField &getPrefix() const = 0;
+};
+
 /** Helper for the "Length-Value" idiom
  *
  * A "Length-Value" structure is an array preceded by its number of items.
@@ -46,7 +67,7 @@ namespace structure
  * @tparam Prefix : The type of field prefixing the array (must contain an integer).
  */
 template <typename Prefix>
-class PrefixedArray : public Block
+class PrefixedArray : public GenericPrefixedArray
 {
     /** @todo Should this rely on the return type of Prefix::getValue() instead? */
     static_assert(std::is_integral<typename Prefix::Storage>::value,
@@ -56,7 +77,8 @@ public:
     template <typename ItemType, typename... Args>
     PrefixedArray(const std::string &name, ItemType &&itemType,
                   const std::string &prefixName = "count", Args &&... args)
-        : Block(name, std::forward<ItemType>(itemType), std::forward<Args>(args)...),
+        : GenericPrefixedArray(name, std::forward<ItemType>(itemType),
+                               std::forward<Args>(args)...),
           mPrefix(prefixName)
     {
         static_assert(not disjunction<is_structure<Args>...>::value,
@@ -65,6 +87,15 @@ public:
 
     std::string getTypeName() const override { return "LV (" + mPrefix.getTypeName() + ")"; }
 
+    const GenericField &getPrefix() const override { return mPrefix; }
+
+protected:
+    void fingerprint(detail::Hasher &hasher) const override
+    {
+        GenericPrefixedArray::fingerprint(hasher);
+        hasher.add(mPrefix.getFingerprint());
+    }
+
 private:
     std::unique_ptr<StructureValue> doBuild(ValueImporter &importer,
                                             const std::string &path) const override
@@ -90,6 +121,30 @@ private:
         value->addValue(std::move(arrayValue));
         return std::move(value);
     }
+    std::unique_ptr<StructureValue> doBuildDefault() const override
+    {
+        using Count = typename Prefix::Storage;
+        auto value = std::make_unique<BlockValue>(*this);
+        value->addValue(std::make_unique<FieldValue<Prefix>>(mPrefix, Count{0}));
+        value->addValue(std::make_unique<BlockValue>(*this));
+        return value;
+    }
+    std::shared_ptr<StructureValue> doInstantiate(
+        const StructureValue &prototype,
+        const std::shared_ptr<detail::Arena> &arena) const override
+    {
+        const auto &children = static_cast<const BlockValue &>(prototype).getFields();
+        auto value = detail::makeShared<BlockValue>(arena, *this);
+        value->adoptValue(mPrefix.instantiateFrom(*children.front(), arena));
+
+        auto arrayValue = detail::makeShared<BlockValue>(arena, *this);
+        const auto &item = getFields()[0].get();
+        for (const auto &child : static_cast<const BlockValue &>(*children.back()).getFields()) {
+            arrayValue->adoptValue(item.instantiateFrom(*child, arena));
+        }
+        value->adoptValue(std::move(arrayValue));
+        return value;
+    }
 
     Prefix mPrefix;
 };
@@ -28,23 +28,79 @@
 
 #include "structure/type/detail/stock.fw.hpp"
 #include "structure/type/Field.hpp"
+#include "structure/attributes/StringEncoding.hpp"
+
+#include <cstdint>
+#include <stdexcept>
 
 namespace structure
 
 {
+struct StringAttributes : GenericFieldAttributes
+{
+    void set(const attributes::StringEncoding &encoding);
+    template <typename C>
+    void set(const C &c)
+    {
+        GenericFieldAttributes::set(c);
+    }
+
+    void fingerprint(detail::Hasher &hasher) const
+    {
+        GenericFieldAttributes::fingerprint(hasher);
+        // Only hashed when set so that the fingerprints of NUL-terminated strings do not change.
+        if (mEncoding.mKind != attributes::StringEncoding::Kind::NulTerminated) {
+            hasher.add(static_cast<uint64_t>(mEncoding.mKind));
+            hasher.add(mEncoding.mSize);
+        }
+    }
+
+    attributes::StringEncoding mEncoding = attributes::StringEncoding::nulTerminated();
+};
+
+inline void StringAttributes::set(const attributes::StringEncoding &encoding)
+{
+    using Kind = attributes::StringEncoding::Kind;
+    if (encoding.mKind == Kind::Prefixed and encoding.mSize != 1 and encoding.mSize != 2 and
+        encoding.mSize != 4 and encoding.mSize != 8) {
+        throw std::invalid_argument("String length prefixes must be 1, 2, 4 or 8 bytes wide");
+    }
+    mEncoding = encoding;
+}
+
 /** A type of field containing an string value. */
 // Theoretically, if this class is not exported and someone tries to derive from it, MSVC will
 // produce a warning. However, exporting it makes MSVC crash... Since this class is completely
 // defined in its header, it is probably ok not to export it.
-class String : public detail::FieldCrtp<String, GenericField, std::string>
+class String : public detail::FieldCrtp<String, GenericField, std::string, StringAttributes>
 {
 private:
-    using Base = detail::FieldCrtp<String, GenericField, std::string>;
+    using Base = detail::FieldCrtp<String, GenericField, std::string, StringAttributes>;
 
 public:
     using Base::Base;
 
+    attributes::StringEncoding getStringEncoding() const override
+    {
+        return getAttributes().mEncoding;
+    }
+
+    /** @returns whether the string can be represented with the field's encoding */
+    bool isAllowed(const std::string &value) const
+    {
+        const auto &encoding = getAttributes().mEncoding;
+        switch (encoding.mKind) {
+        case attributes::StringEncoding::Kind::Prefixed:
+            return encoding.mSize >= sizeof(uint64_t) or value.size() >> (8 * encoding.mSize) == 0;
+        case attributes::StringEncoding::Kind::FixedCapacity:
+            return value.size() <= encoding.mSize;
+        default:
+            return true;
+        }
+    }
+
     /** @returns the human-readable name of the field type */
     static std::string typeToString() { return "String"; }
+    static StructureTraits traits() { return {StructureKind::String}; }
 };
 } // namespace structure
@@ -28,8 +28,13 @@
 
 #include "structure/structure_export.h"
 
+#include "structure/attributes/Alignment.hpp"
 #include "structure/attributes/Description.hpp"
+#include "structure/detail/Hasher.hpp"
+#include "structure/Layout.hpp"
+#include "structure/Symbol.hpp"
 
+#include <cstdint>
 #include <initializer_list>
 #include <string>
 #include <map>
@@ -41,6 +46,70 @@ namespace structure
 class StructureValue;
 class StructureVisitor;
 class ValueImporter;
+class Structure;
+namespace detail
+{
+class Arena;
+
+/** A link from a structure to the block containing it
+ *
+ * Copies and moves of a structure are not contained anywhere yet: they start unlinked.
+ */
+class ParentLink
+{
+public:
+    ParentLink() = default;
+    ParentLink(const ParentLink &) {}
+    ParentLink &operator=(const ParentLink &) { return *this; }
+
+    Structure *get() const { return mParent; }
+    void set(Structure *parent) { mParent = parent; }
+
+private:
+    Structure *mParent = nullptr;
+};
+} // namespace detail
+
+/** What a structure is; see StructureTraits */
+enum class StructureKind : uint8_t
+{
+    Block,
+    Array,
+    VarArray,
+    PrefixedArray,
+    Integer,
+    FloatingPoint,
+    FixedQ,
+    String,
+    FixedString,
+    Bool,
+    /** Fields of types which are not provided by libstructure */
+    Field
+};
+
+/** The kind of a structure and its numeric characteristics
+ *
+ * They are stored in the structure itself: unlike a StructureVisitor or getTypeName(), reading
+ * them requires neither a virtual call nor an allocation, so that hot loops may switch on them.
+ */
+struct StructureTraits
+{
+    StructureKind kind = StructureKind::Field;
+    /** Integers and Q numbers: whether they are signed; always true for floating points */
+    bool isSigned = false;
+    /** Numbers: their size in bits; fixed strings: their capacity in characters */
+    uint32_t size = 0;
+    /** Q numbers: the size of their fractional part in bits */
+    uint32_t fractional = 0;
+    /** Arrays: their number of items */
+    size_t count = 0;
+
+    bool isBlock() const
+    {
+        return kind == StructureKind::Block or kind == StructureKind::Array or
+               kind == StructureKind::VarArray or kind == StructureKind::PrefixedArray;
+    }
+};
 
 /** Base class for all structure types.
  *
@@ -75,18 +144,47 @@ public:
      */
     virtual void accept(StructureVisitor &visitor) const = 0;
 
-    /** Return the structure's name; see the main description. */
-    std::string getName() const;
+    /** Return the structure's name; see the main description.
+     *
+     * Names are interned (see Symbol): the reference remains valid after the structure is gone.
+     */
+    const std::string &getName() const { return mName.str(); }
+    /** Return the structure's name as a symbol, for fast comparisons and hashing */
+    Symbol getSymbol() const { return mName; }
     /** Return the structure's description; see the main description. */
     virtual std::string getDescription() const = 0;
     /** Return the structure's type name; see the main description */
     virtual std::string getTypeName() const = 0;
+    /** Return the structure's alignment attribute, or 0 if it has none; see LayoutPolicy */
+    virtual size_t getAlignment() const = 0;
+
+    /** Return the kind of the structure, without any virtual call */
+    StructureKind getKind() const { return mTraits.kind; }
+    /** Return the kind and the numeric characteristics of the structure, without any virtual call
+     */
+    const StructureTraits &getTraits() const { return mTraits; }
 
     /** Set an arbitrary metadata. */
     void setMetadata(const std::string &key, const std::string &value = "");
     /** Get the map of metadata. */
     const std::map<std::string, std::string> &getMetadata() const;
 
+    /** Return a hash of the structure's definition.
+     *
+     * It covers the type name, the name, the attributes and the metadata of the structure and, for
+     * blocks, the fingerprints of their children. It is computed on the first call and cached.
+     *
+     * Fingerprints are stable across processes and platforms: they can be stored alongside
+     * exported data in order to detect that the data does not match a structure anymore.
+     */
+    uint64_t getFingerprint() const;
+
+    /** Return the binary layout of the structure's values.
+     *
+     * It is computed on the first call for each policy and cached; see Layout.
+     */
+    std::shared_ptr<const Layout> getLayout(LayoutPolicy policy = LayoutPolicy::Packed) const;
+
     /** Create a StructureValue from a value importer
      *
      * Usage exemple:
@@ -106,13 +204,98 @@ public:
     std::unique_ptr<StructureValue> build(ValueImporter &importer,
                                           const std::string &path = "") const;
 
+    /** Create a StructureValue from the Default attributes of its fields
+     *
+     * This is equivalent to building the value with the DefaultImporter, but faster: the defaults
+     * are converted once (see GenericField::withDefault()) and no importer is involved. Variable
+     * length arrays are empty (and the prefixes of prefixed arrays are 0).
+     *
+     * @throws NoDefaultValue if a field does not have a Default attribute
+     */
+    std::unique_ptr<StructureValue> buildDefault() const { return doBuildDefault(); }
+
+    /** Create a StructureValue by copying a prototype value
+     *
+     * This is meant for creating many similar values: build a prototype once (e.g. with
+     * buildDefault()), then instantiate it and modify a few fields of each copy. Like
+     * StructureValue::clone(), the copy is allocated in bulk; unlike it, the copy refers to this
+     * structure rather than to the prototype's.
+     *
+     * @param[in] prototype A value of a structure equal to this one (see
+     *                      operator==(const Structure &, const Structure &))
+     * @throws ValueStructureMismatch if the prototype's structure is not equal to this one
+     */
+    std::unique_ptr<StructureValue> instantiateFrom(const StructureValue &prototype) const;
+    /** Same as instantiateFrom(const StructureValue &) but allocated in an arena
+     *
+     * The prototype is not checked. Internal: this is how blocks instantiate their children.
+     */
+    std::shared_ptr<StructureValue> instantiateFrom(
+        const StructureValue &prototype, const std::shared_ptr<detail::Arena> &arena) const
+    {
+        return doInstantiate(prototype, arena);
+    }
+
+protected:
+    /** Add the type-specific properties of the structure to its fingerprint
+     *
+     * Overrides must call their parent class' implementation.
+     */
+    virtual void fingerprint(detail::Hasher &hasher) const { (void)hasher; }
+    /** Must be called by the constructors of derived classes */
+    void setTraits(const StructureTraits &traits) { mTraits = traits; }
+    /** Must be called by blocks on each of their children, including after being moved */
+    void adoptChild(Structure &child) { child.mParent.set(this); }
+    /** Must be called whenever the structure's definition changes
+     *
+     * The fingerprints of the blocks containing the structure are invalidated as well.
+     */
+    void invalidateFingerprint();
+    /** Must be called whenever the structure's children change
+     *
+     * The layouts of the blocks containing the structure are invalidated as well.
+     */
+    void invalidateLayout();
+
 private:
     virtual std::unique_ptr<StructureValue> doBuild(ValueImporter &importer,
                                                     const std::string &path) const = 0;
-    std::string mName;
+    /** Builds the value with the DefaultImporter unless overridden */
+    virtual std::unique_ptr<StructureValue> doBuildDefault() const;
+    /** Clones the prototype unless overridden */
+    virtual std::shared_ptr<StructureValue> doInstantiate(
+        const StructureValue &prototype, const std::shared_ptr<detail::Arena> &arena) const;
+
+    /** Feeds the definition of the structure to the hasher, its children by their fingerprints */
+    void hashDefinition(detail::Hasher &hasher) const;
+    /** Three-way comparison of structures whose fingerprints are equal, in case they collide
+     *
+     * @returns 0 if their definitions are equal; otherwise, a consistent (but arbitrary) order.
+     */
+    static int compareDefinitions(const Structure &lhs, const Structure &rhs);
+    friend STRUCTURE_EXPORT bool operator==(const Structure &lhs, const Structure &rhs);
+    friend STRUCTURE_EXPORT int compare(const StructureValue &lhs, const StructureValue &rhs);
+
+    Symbol mName;
+    StructureTraits mTraits;
     std::map<std::string, std::string> mMetadata;
+    detail::HashCache mFingerprint;
+    detail::LayoutCache mLayout;
+    detail::ParentLink mParent;
 };
 
+/** Structural equality
+ *
+ * Structures are compared by fingerprint first (see Structure::getFingerprint()): unequal
+ * structures are told apart without browsing them once their fingerprints are known. Matching
+ * fingerprints are confirmed by comparing the definitions, since hashes may collide.
+ *
+ * @returns whether both structures have the same definition
+ */
+STRUCTURE_EXPORT bool operator==(const Structure &lhs, const Structure &rhs);
+/** Structural inequality; see operator==(const Structure &, const Structure &) */
+STRUCTURE_EXPORT bool operator!=(const Structure &lhs, const Structure &rhs);
+
 /** Helper type trait for checking that a type is a Structure
  *
  * It helps preventing complicated error messages further down the stack.
@@ -124,6 +307,20 @@ struct is_structure : std::is_base_of<Structure, T>
 {
 };
 
+/** Helper type trait for checking that a type is an owning pointer to a Structure
+ *
+ * Blocks and arrays accept them in place of structures, for children whose type is only known at
+ * runtime.
+ */
+template <typename T>
+struct is_structure_ptr : std::false_type
+{
+};
+template <typename T>
+struct is_structure_ptr<std::unique_ptr<T>> : is_structure<T>
+{
+};
+
 /** Base class for all attribute classes
  *
  * All fields must have these attributes. For now, it only contains a description attribute.
@@ -131,7 +328,25 @@ struct is_structure : std::is_base_of<Structure, T>
 struct STRUCTURE_EXPORT StructureAttributes
 {
     void set(const attributes::Description &desc) { mDescription = desc.mValue; }
+    void set(const attributes::Alignment &alignment)
+    {
+        mAlignment = checkAlignment(alignment.mValue);
+    }
+
+    /** Add the attributes to the fingerprint of the structure
+     *
+     * The description and the alignment are already part of it; attribute classes with additional
+     * attributes must hide this method.
+     */
+    void fingerprint(detail::Hasher &) const {}
+
+    /** @returns the alignment if it is a power of two
+     *
+     * @throws std::invalid_argument otherwise
+     */
+    static size_t checkAlignment(size_t alignment);
 
     std::string mDescription;
+    size_t mAlignment = 0;
 };
 }
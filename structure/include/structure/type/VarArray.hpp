@@ -41,23 +41,31 @@ class STRUCTURE_EXPORT VarArray : public Block
 public:
     /** Constructs a Variable-Length Array of any kind of field.
      *
-     * @param[in] itemType The structure that is repeated in the array.
+     * @param[in] itemType The structure that is repeated in the array (or a std::unique_ptr to it).
      * @param[in] args Attributes of the VarArray
      */
     template <class ItemType, typename... Args>
     VarArray(const std::string &name, ItemType &&itemType, Args &&... args)
         : Block(name, std::forward<ItemType>(itemType), std::forward<Args>(args)...)
     {
-        static_assert(is_structure<ItemType>::value,
+        static_assert(is_structure<ItemType>::value or
+                          is_structure_ptr<typename std::decay<ItemType>::type>::value,
                       "The ItemType in a VarArray must be a Structure");
         static_assert(not disjunction<is_structure<Args>...>::value,
                       "The arguments after ItemType must not be Structures");
+        setTraits({StructureKind::VarArray});
     }
 
+    void accept(StructureVisitor &visitor) const override;
+
     std::string getTypeName() const override;
 
 private:
     std::unique_ptr<StructureValue> doBuild(ValueImporter &importer,
                                             const std::string &path) const override;
+    std::unique_ptr<StructureValue> doBuildDefault() const override;
+    std::shared_ptr<StructureValue> doInstantiate(
+        const StructureValue &prototype,
+        const std::shared_ptr<detail::Arena> &arena) const override;
 };
 } // namespace structure
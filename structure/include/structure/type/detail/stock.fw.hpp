@@ -28,15 +28,20 @@
 
 /* This file ensures that declarations are aligned everywhere */
 
+#include <cstddef>
+
 namespace structure
 {
 class Integer;
 class FloatingPoint;
 class FixedQ;
 class String;
+template <size_t>
+class FixedString;
 class Bool;
 class Block;
 class VarArray;
+class GenericPrefixedArray;
 template <typename>
 class PrefixedArray;
 class Array;
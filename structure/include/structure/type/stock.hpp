@@ -36,6 +36,7 @@
 #include "structure/type/FloatingPoint.hpp"
 #include "structure/type/FixedQ.hpp"
 #include "structure/type/String.hpp"
+#include "structure/type/FixedString.hpp"
 #include "structure/type/Bool.hpp"
 #include "structure/type/Block.hpp"
 #include "structure/type/VarArray.hpp"
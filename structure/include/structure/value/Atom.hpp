@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/structure_export.h"
+#include "structure/Exception.hpp"
+
+#include "structure/detail/safe_cast.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace structure
+{
+
+class StorageVisitor;
+
+/** The in-memory value of a field, independently of its type
+ *
+ * An Atom holds one of the canonical storage types of StorageVisitor: `unsigned long long`,
+ * `long long`, `long double`, `bool` or `std::string`. Other arithmetic types are widened into one
+ * of them, the same way StorageVisitor does it.
+ */
+class STRUCTURE_EXPORT Atom
+{
+public:
+    enum class Kind : uint8_t
+    {
+        Unsigned,
+        Signed,
+        Floating,
+        Boolean,
+        String
+    };
+
+    Atom() = default;
+    Atom(bool value) : mKind(Kind::Boolean), mBoolean(value) {}
+    Atom(const std::string &value) : mKind(Kind::String), mString(value) {}
+    Atom(const char *value) : mKind(Kind::String), mString(value) {}
+
+    /** Constructs an Atom from an unsigned integer */
+    template <class T>
+    Atom(T value, typename std::enable_if<std::is_integral<T>::value and
+                                          std::is_unsigned<T>::value>::type * = 0)
+        : mKind(Kind::Unsigned), mUnsigned(value)
+    {
+    }
+    /** Constructs an Atom from a signed integer */
+    template <class T>
+    Atom(T value, typename std::enable_if<std::is_integral<T>::value and
+                                          std::is_signed<T>::value>::type * = 0)
+        : mKind(Kind::Signed), mSigned(value)
+    {
+    }
+    /** Constructs an Atom from a floating point number */
+    template <class T>
+    Atom(T value, typename std::enable_if<std::is_floating_point<T>::value>::type * = 0)
+        : mKind(Kind::Floating), mFloating(value)
+    {
+    }
+
+    Kind getKind() const { return mKind; }
+
+    unsigned long long getUnsigned() const { return mUnsigned; }
+    long long getSigned() const { return mSigned; }
+    long double getFloating() const { return mFloating; }
+    bool getBoolean() const { return mBoolean; }
+    const std::string &getString() const { return mString; }
+
+    /** Converts the atom into a storage type
+     *
+     * @tparam Storage The storage type of a field
+     * @throws ParseError if the atom is of an incompatible kind or does not fit into Storage.
+     */
+    template <class Storage>
+    Storage as() const try {
+        return convert(static_cast<Storage *>(nullptr));
+    } catch (CastError &e) {
+        throw ParseError(e.what());
+    }
+
+    /** Visits the atom as if it were the storage of a field */
+    void accept(StorageVisitor &visitor) const;
+
+    /** Compare atoms, with the same semantics as value comparison
+     *
+     * @see ValueComparison
+     */
+    friend bool operator==(const Atom &lhs, const Atom &rhs) { return lhs.equals(rhs); }
+    friend bool operator!=(const Atom &lhs, const Atom &rhs) { return not lhs.equals(rhs); }
+
+private:
+    bool equals(const Atom &other) const;
+
+    [[noreturn]] void wrongKind(const char *expected) const;
+
+    bool convert(bool *) const
+    {
+        if (mKind != Kind::Boolean) {
+            wrongKind("Boolean");
+        }
+        return mBoolean;
+    }
+    std::string convert(std::string *) const
+    {
+        if (mKind != Kind::String) {
+            wrongKind("String");
+        }
+        return mString;
+    }
+    template <class T>
+    typename std::enable_if<std::is_integral<T>::value, T>::type convert(T *) const
+    {
+        switch (mKind) {
+        case Kind::Unsigned:
+            return safe_cast<T>(mUnsigned);
+        case Kind::Signed:
+            return safe_cast<T>(mSigned);
+        default:
+            wrongKind("Integer");
+        }
+    }
+    /** For string storages other than std::string (e.g. InlineString) */
+    template <class T>
+    typename std::enable_if<std::is_class<T>::value and
+                                std::is_constructible<T, const std::string &>::value,
+                            T>::type
+    convert(T *) const
+    {
+        if (mKind != Kind::String) {
+            wrongKind("String");
+        }
+        try {
+            return T(mString);
+        } catch (std::length_error &e) {
+            throw ParseError(e.what());
+        }
+    }
+    template <class T>
+    typename std::enable_if<std::is_floating_point<T>::value, T>::type convert(T *) const
+    {
+        if (mKind != Kind::Floating) {
+            wrongKind("FloatingPoint");
+        }
+        // NaNs and infinities are not "in range" but are representable anyway.
+        return std::isfinite(mFloating) ? safe_cast<T>(mFloating) : static_cast<T>(mFloating);
+    }
+
+    Kind mKind = Kind::Unsigned;
+    union
+    {
+        unsigned long long mUnsigned = 0;
+        long long mSigned;
+        long double mFloating;
+        bool mBoolean;
+    };
+    std::string mString;
+};
+} // namespace structure
@@ -29,6 +29,7 @@
 #include "structure/type/Block.hpp"
 #include "structure/value/StructureValue.hpp"
 #include "structure/Visitor.hpp"
+#include "structure/detail/Arena.hpp"
 
 #include <initializer_list>
 #include <string>
@@ -41,12 +42,64 @@ class BlockValue : public StructureValue
 {
 public:
     BlockValue(const Block &block) : mStructure(block) {}
+    /** Takes the children of a block value which is not contained in any block */
+    BlockValue(BlockValue &&other)
+        : StructureValue(other), mStructure(other.mStructure), mValues(std::move(other.mValues)),
+          mFieldCount(other.mFieldCount)
+    {
+        other.mValues.clear();
+        other.mFieldCount = 0;
+        for (auto &value : mValues) {
+            // Shared values have no parent.
+            if (value->mParent == &other) {
+                value->mParent = this;
+            }
+        }
+        if (other.isDirty()) {
+            markDirty();
+        }
+    }
 
     /** Add a child value at the end of the block value */
-    void addValue(std::unique_ptr<StructureValue> child) { mValues.push_back(std::move(child)); }
+    void addValue(std::unique_ptr<StructureValue> child)
+    {
+        checkMutable();
+        child->mParent = this;
+        adopt(*child);
+        mValues.push_back(std::move(child));
+    }
 
-    /** @returns the list of children */
-    const std::list<std::unique_ptr<StructureValue>> &getFields() const { return mValues; }
+    /** Add a child value which may be shared with other blocks
+     *
+     * This is how values share their unchanged subtrees (see structure::patch(const SharedValue &,
+     * const Delta &)). A shared value is immutable: modifying it or any of its children, through
+     * any of the blocks containing it (including the one it was created in), throws
+     * ImmutableValue. It is detached from its original parent, which it may outlive: dirty bits
+     * are never set through it.
+     *
+     * @throws ImmutableValue if this block is itself shared.
+     */
+    void addShared(std::shared_ptr<const StructureValue> child)
+    {
+        checkMutable();
+        // Shared values were created as mutable values: freezing them is legitimate.
+        auto &shared = const_cast<StructureValue &>(*child);
+        if (not shared.mShared.exchange(true)) {
+            shared.mParent = nullptr;
+        }
+        adopt(*child);
+        mValues.push_back(std::const_pointer_cast<StructureValue>(std::move(child)));
+    }
+
+    /** @returns the list of children
+     *
+     * Shared children (see addShared()) can't be modified.
+     *
+     * @note API change: children used to be returned as a
+     *       std::list<std::unique_ptr<StructureValue>>. Now that they can be shared, they are held
+     *       by std::shared_ptr; code spelling out the former type must be updated (or use auto).
+     */
+    const std::list<std::shared_ptr<StructureValue>> &getFields() const { return mValues; }
     /** @returns the Block type corresponding to this value
      *
      * Same as getStructure() but with a stronger type.
@@ -54,11 +107,75 @@ public:
     const Block &getBlock() const { return mStructure; }
     const Structure &getStructure() const override { return (const Structure &)mStructure; }
 
+    size_t getFieldCount() const override { return mFieldCount; }
+
+    std::unique_ptr<StructureValue> clone() const override
+    {
+        std::unique_ptr<StructureValue> copy = std::make_unique<BlockValue>(mStructure);
+        if (not mValues.empty()) {
+            auto arena = std::make_shared<detail::Arena>();
+            cloneChildren(static_cast<BlockValue &>(*copy), arena);
+        }
+        return copy;
+    }
+
     virtual void accept(ValueVisitor &visitor) const override { visitor.visit(*this); }
     virtual void accept(StorageVisitor &visitor) const override { visitor.visitStorage(*this); }
 
+    void clearDirty() override
+    {
+        if (not isDirty()) {
+            // Children of a clean block are clean as well.
+            return;
+        }
+        StructureValue::clearDirty();
+        for (auto &value : mValues) {
+            value->clearDirty();
+        }
+    }
+
+    /** Add a child value at the end of the block value, when it is allocated by the caller (e.g.
+     * in a detail::Arena) rather than owned by a std::unique_ptr
+     *
+     * Unlike addShared(), the block takes ownership of the value.
+     */
+    void adoptValue(std::shared_ptr<StructureValue> child)
+    {
+        checkMutable();
+        child->mParent = this;
+        adopt(*child);
+        mValues.push_back(std::move(child));
+    }
+
 private:
+    std::shared_ptr<StructureValue> cloneIn(
+        const std::shared_ptr<detail::Arena> &arena) const override
+    {
+        auto copy = detail::makeShared<BlockValue>(arena, mStructure);
+        cloneChildren(*copy, arena);
+        return copy;
+    }
+    void cloneChildren(BlockValue &copy, const std::shared_ptr<detail::Arena> &arena) const
+    {
+        for (const auto &value : mValues) {
+            copy.adoptValue(value->cloneIn(arena));
+        }
+    }
+
+    void adopt(const StructureValue &child)
+    {
+        auto count = child.getFieldCount();
+        // Blocks only ever have blocks as parents.
+        for (StructureValue *block = this; block != nullptr; block = block->mParent) {
+            static_cast<BlockValue *>(block)->mFieldCount += count;
+        }
+        if (child.isDirty()) {
+            markDirty();
+        }
+    }
+
     const Block &mStructure;
-    std::list<std::unique_ptr<StructureValue>> mValues;
+    std::list<std::shared_ptr<StructureValue>> mValues;
+    size_t mFieldCount = 0;
 };
 }
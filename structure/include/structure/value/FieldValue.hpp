@@ -29,6 +29,7 @@
 #include "structure/value/GenericFieldValue.hpp"
 #include "structure/Visitor.hpp"
 
+#include "structure/detail/Arena.hpp"
 #include "structure/detail/safe_cast.hpp"
 
 #include <initializer_list>
@@ -67,7 +68,7 @@ class FieldValue : public GenericFieldValue
 
 public:
     /** Constructs a value from a Field and a string (e.g. user input) */
-    FieldValue(FieldType field, const std::string &value)
+    FieldValue(const FieldType &field, const std::string &value)
         : mStructure(field), mValue(mStructure.fromString(value))
     {
         if (not field.isAllowed(mValue)) {
@@ -76,8 +77,7 @@ public:
     }
     /** Constructs a value from a Field and typed value */
     template <typename T>
-    FieldValue(FieldType field, const T &value)
-        : mStructure(field), mValue(safe_cast<typename FieldType::Storage>(value))
+    FieldValue(const FieldType &field, const T &value) : mStructure(field), mValue(toStorage(value))
     {
         if (not field.isAllowed(mValue)) {
             throw std::range_error("Illegal value");
@@ -89,10 +89,28 @@ public:
      * may be more user-fridendly; floats are represented with a fixed precision but we may want to
      * have a control over this). */
     std::string getValue() const override { return std::to_string(mValue); }
-    void setValue(const std::string &value) { mValue = mStructure.fromString(value); }
+    void setValue(const std::string &value)
+    {
+        checkMutable();
+        mValue = mStructure.fromString(value);
+        markDirty();
+    }
 
     typename FieldType::Storage getTypedValue() const { return mValue; }
-    void setTypedValue(const typename FieldType::Storage &value) { mValue = value; }
+    void setTypedValue(const typename FieldType::Storage &value)
+    {
+        checkMutable();
+        mValue = value;
+        markDirty();
+    }
+
+    Atom getStorage() const override { return Atom(mValue); }
+    void setStorage(const Atom &storage) override
+    {
+        mValue = checked(storage);
+        markDirty();
+    }
+    void checkStorage(const Atom &storage) const override { checked(storage); }
 
     /** @returns the Field type corresponding to this value
      *
@@ -101,10 +119,41 @@ public:
     const FieldType &getField() const { return mStructure; }
     const Structure &getStructure() const override { return mStructure; }
 
+    std::unique_ptr<StructureValue> clone() const override
+    {
+        return std::make_unique<FieldValue>(*this);
+    }
+
     void accept(ValueVisitor &visitor) const override { visitor.visit(*this); }
     void accept(StorageVisitor &visitor) const override { visitor.visitStorage(mValue); }
 
 private:
+    using Storage = typename FieldType::Storage;
+
+    std::shared_ptr<StructureValue> cloneIn(
+        const std::shared_ptr<detail::Arena> &arena) const override
+    {
+        return detail::makeShared<FieldValue>(arena, *this);
+    }
+
+    Storage checked(const Atom &storage) const
+    {
+        checkMutable();
+        auto value = storage.as<Storage>();
+        if (not mStructure.isAllowed(value)) {
+            throw std::range_error("Illegal value");
+        }
+        return value;
+    }
+
+    template <typename T>
+    static Storage toStorage(const T &value)
+    {
+        return safe_cast<Storage>(value);
+    }
+    /** Storages which are not arithmetic can't be safe_cast, even to themselves */
+    static const Storage &toStorage(const Storage &value) { return value; }
+
     const FieldType mStructure;
     typename FieldType::Storage mValue;
 };
@@ -29,6 +29,7 @@
 #include "structure/structure_export.h"
 
 #include "structure/value/StructureValue.hpp"
+#include "structure/value/Atom.hpp"
 
 namespace structure
 {
@@ -38,5 +39,24 @@ class STRUCTURE_EXPORT GenericFieldValue : public StructureValue
 public:
     /** @return the human representation of the value */
     virtual std::string getValue() const = 0;
+
+    size_t getFieldCount() const override { return 1; }
+
+    /** @return the in-memory value */
+    virtual Atom getStorage() const = 0;
+    /** Replace the in-memory value
+     *
+     * The value is left untouched if the storage is rejected.
+     *
+     * @throws ParseError if the atom can't be converted to the type of the field's storage
+     * @throws std::range_error if the field does not allow the storage (see e.g. attributes::Range)
+     * @throws ImmutableValue if the field is shared (see BlockValue::addShared())
+     */
+    virtual void setStorage(const Atom &storage) = 0;
+    /** Check that setStorage() would accept a storage, without modifying the value
+     *
+     * @throws the same exceptions as setStorage()
+     */
+    virtual void checkStorage(const Atom &storage) const = 0;
 };
 }
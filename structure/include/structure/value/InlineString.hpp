@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace structure
+{
+/** A string of at most `Capacity` characters, stored inline (without any allocation)
+ *
+ * It is the storage of FixedString fields. It converts implicitly from and to std::string so that
+ * it can be used wherever a string storage is expected.
+ */
+template <size_t Capacity>
+class InlineString
+{
+public:
+    InlineString() = default;
+    /** @throws std::length_error if `value` has more than `Capacity` characters */
+    InlineString(const char *value) : InlineString(value, std::strlen(value)) {}
+    /** @throws std::length_error if `value` has more than `Capacity` characters */
+    InlineString(const std::string &value) : InlineString(value.data(), value.size()) {}
+    /** @throws std::length_error if `size` is larger than `Capacity` */
+    InlineString(const char *chars, size_t size) : mSize(size)
+    {
+        if (size > Capacity) {
+            throw std::length_error("\"" + std::string(chars, size) + "\" has more than " +
+                                    std::to_string(Capacity) + " characters");
+        }
+        std::memcpy(mChars, chars, size);
+        mChars[size] = '\0';
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+    /** @returns the characters, followed by a NUL character */
+    const char *data() const { return mChars; }
+    const char *c_str() const { return mChars; }
+
+    std::string str() const { return std::string(mChars, mSize); }
+    operator std::string() const { return str(); }
+
+    friend bool operator==(const InlineString &lhs, const InlineString &rhs)
+    {
+        return lhs.mSize == rhs.mSize and std::memcmp(lhs.mChars, rhs.mChars, lhs.mSize) == 0;
+    }
+    friend bool operator!=(const InlineString &lhs, const InlineString &rhs)
+    {
+        return not(lhs == rhs);
+    }
+
+private:
+    char mChars[Capacity + 1] = {};
+    size_t mSize = 0;
+};
+} // namespace structure
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/structure_export.h"
+
+#include "structure/value/StructureValue.hpp"
+#include "structure/value/Atom.hpp"
+#include "structure/Delta.hpp"
+
+#include <memory>
+
+namespace structure
+{
+
+/** @defgroup SharedValue Structurally shared values
+ *
+ * Values held by a SharedValue are immutable: their shared subtrees can't be modified at all
+ * (doing so throws ImmutableValue) and the others must not be. Instead of being modified in
+ * place, they are patched into a new version which shares all the unchanged subtrees with the
+ * original one: only the blocks on the path from the root to a modified field are copied.
+ * Copying a SharedValue is O(1) and keeping many versions of a large value only costs the
+ * differences between them.
+ *
+ * Values owned by a std::unique_ptr (e.g. returned by Block::with()) are turned into shared values
+ * by a mere conversion; they must not be modified afterwards.
+ *
+ * Example:
+ * @code
+ * SharedValue v1 = root.with({...});
+ * auto v2 = patch(v1, 3, Atom(42));
+ * auto v3 = patch(v2, diff(*v2, *other));
+ * // v1, v2 and v3 are all valid and share most of their blocks and fields.
+ * @endcode
+ * @{
+ */
+
+/** An immutable value, possibly sharing subtrees with other values */
+using SharedValue = std::shared_ptr<const StructureValue>;
+
+/** @returns a copy of a value with changes applied, sharing the unchanged subtrees
+ *
+ * Only the `after` part of the changes is used. In the returned value, the modified fields and
+ * the blocks containing them are dirty and nothing else is (see StructureValue::isDirty()). The
+ * original value is left untouched.
+ *
+ * @param[in] value The value to be patched
+ * @param[in] delta The changes, typically computed by diff()
+ * @throws ValueStructureMismatch if the delta was computed for values of a different Structure or
+ *         refers to a field that the value does not have.
+ * @throws ParseError if a new storage does not fit in its field.
+ */
+STRUCTURE_EXPORT SharedValue patch(const SharedValue &value, const Delta &delta);
+
+/** @returns a copy of a value with one field changed, sharing the unchanged subtrees
+ *
+ * @param[in] value The value to be patched
+ * @param[in] field The index of the field, in depth-first order
+ * @param[in] storage The new storage of the field
+ * @see patch(const SharedValue &, const Delta &)
+ */
+STRUCTURE_EXPORT SharedValue patch(const SharedValue &value, size_t field, const Atom &storage);
+/** @} */
+} // namespace structure
@@ -30,7 +30,10 @@
 
 #include "structure/type/Structure.hpp"
 
+#include <atomic>
+#include <cstdint>
 #include <initializer_list>
+#include <memory>
 #include <string>
 
 namespace structure
@@ -38,6 +41,11 @@ namespace structure
 
 class ValueVisitor;
 class StorageVisitor;
+class BlockValue;
+namespace detail
+{
+class Arena;
+}
 /** The base class for all values (atomic and aggregates) */
 class STRUCTURE_EXPORT StructureValue
 {
@@ -54,9 +62,189 @@ public:
      */
     virtual void accept(StorageVisitor &visitor) const = 0;
 
-    std::string getName() const;
+    /** @returns the name of the value's structure; see Structure::getName() */
+    const std::string &getName() const;
+    /** @returns the name of the value's structure as a symbol; see Structure::getSymbol() */
+    Symbol getSymbol() const;
 
     /** @returns the Structure with which this value was instantiated */
     virtual const Structure &getStructure() const = 0;
+
+    /** @returns the number of fields (i.e. leaves) in the value */
+    virtual size_t getFieldCount() const = 0;
+
+    /** @returns a deep copy of the value
+     *
+     * The copy is not dirty (see isDirty()). The children of a block are allocated in bulk (see
+     * detail::Arena): cloning a prototype is much cheaper than building a value from an importer.
+     * See also Structure::instantiateFrom().
+     */
+    virtual std::unique_ptr<StructureValue> clone() const = 0;
+
+    /** @returns whether the value has been modified since its creation or since the last call to
+     * clearDirty()
+     *
+     * A block is dirty if any of its children is. Modifying a field marks it dirty as well as all
+     * the blocks containing it, so that only modified subtrees need to be browsed (see
+     * structure::applyDirty()).
+     */
+    bool isDirty() const { return mDirty; }
+    /** Mark the value and all its children as not modified
+     *
+     * Must not be called on values shared with other blocks (see BlockValue::addShared()).
+     */
+    virtual void clearDirty() { mDirty = false; }
+
+protected:
+    StructureValue() = default;
+    /** Copies are neither contained in a block nor dirty */
+    StructureValue(const StructureValue &) {}
+    StructureValue &operator=(const StructureValue &) = delete;
+
+    /** Mark the value and the blocks containing it as modified
+     *
+     * Must be called by values whenever they are modified.
+     */
+    void markDirty()
+    {
+        // Shared values are not modified and have no parent: the walk never leaves the tree.
+        // A dirty value always has dirty ancestors: we can stop at the first one.
+        for (auto value = this; value != nullptr and not value->mDirty; value = value->mParent) {
+            value->mDirty = true;
+        }
+    }
+    /** Must be called by values before they are modified
+     *
+     * @throws ImmutableValue if the value is shared with other blocks or contained in a value
+     *         which is (see BlockValue::addShared()).
+     */
+    void checkMutable() const;
+
+private:
+    // Blocks set the parent of the values they contain and clone them.
+    friend class BlockValue;
+
+    /** Same as clone() but allocated in an arena */
+    virtual std::shared_ptr<StructureValue> cloneIn(const std::shared_ptr<detail::Arena> &) const
+    {
+        return clone();
+    }
+
+    StructureValue *mParent = nullptr;
+    bool mDirty = false;
+    /** Set once the value is shared; may be set by concurrent writers patching the same version */
+    std::atomic<bool> mShared{false};
+};
+
+/** @defgroup ValueComparison Value comparison
+ *
+ * Values are compared according to their in-memory storage (as seen by a StorageVisitor) rather
+ * than their string representation. Two values are equal if their structures are equal (see
+ * operator==(const Structure &, const Structure &)) and if they hold the same storage. They are
+ * ordered by fingerprint first (structures whose fingerprints collide being ordered by
+ * definition), then lexicographically by storage (in field order, shorter blocks first). For that
+ * purpose, all NaNs are considered equal to each other and greater than any other number.
+ * @{
+ */
+
+/** Three-way comparison of values
+ *
+ * @returns a negative number if lhs < rhs, 0 if lhs == rhs, a positive number otherwise.
+ */
+STRUCTURE_EXPORT int compare(const StructureValue &lhs, const StructureValue &rhs);
+
+namespace detail
+{
+/** Compares the storages of two values whose structures are known to be equal
+ *
+ * This is compare() without the structure comparison, for the library's own use (see Delta).
+ */
+int compareStorage(const StructureValue &lhs, const StructureValue &rhs);
+} // namespace detail
+
+inline bool operator==(const StructureValue &lhs, const StructureValue &rhs)
+{
+    return compare(lhs, rhs) == 0;
+}
+inline bool operator!=(const StructureValue &lhs, const StructureValue &rhs)
+{
+    return compare(lhs, rhs) != 0;
+}
+inline bool operator<(const StructureValue &lhs, const StructureValue &rhs)
+{
+    return compare(lhs, rhs) < 0;
+}
+inline bool operator>(const StructureValue &lhs, const StructureValue &rhs)
+{
+    return compare(lhs, rhs) > 0;
+}
+inline bool operator<=(const StructureValue &lhs, const StructureValue &rhs)
+{
+    return compare(lhs, rhs) <= 0;
+}
+inline bool operator>=(const StructureValue &lhs, const StructureValue &rhs)
+{
+    return compare(lhs, rhs) >= 0;
+}
+
+/** @returns a hash of the value, consistent with value equality
+ *
+ * Like structure fingerprints, it is stable across processes and platforms.
+ */
+STRUCTURE_EXPORT uint64_t hash(const StructureValue &value);
+
+/** Hash function object, for using values as keys of unordered containers
+ *
+ * Example:
+ * @code
+ * std::unordered_set<std::unique_ptr<StructureValue>, ValueHash, ValueEqual> pushed;
+ * if (pushed.insert(std::move(value)).second) {
+ *     // This is a new value
+ * }
+ * @endcode
+ */
+struct ValueHash
+{
+    size_t operator()(const StructureValue &value) const
+    {
+        return static_cast<size_t>(hash(value));
+    }
+    size_t operator()(const std::unique_ptr<StructureValue> &value) const
+    {
+        return (*this)(*value);
+    }
+};
+
+/** Equality function object, for using values as keys of unordered containers */
+struct ValueEqual
+{
+    using is_transparent = void;
+
+    bool operator()(const StructureValue &lhs, const StructureValue &rhs) const
+    {
+        return lhs == rhs;
+    }
+    bool operator()(const std::unique_ptr<StructureValue> &lhs,
+                    const std::unique_ptr<StructureValue> &rhs) const
+    {
+        return *lhs == *rhs;
+    }
+};
+
+/** Ordering function object, for using values as keys of ordered containers */
+struct ValueLess
+{
+    using is_transparent = void;
+
+    bool operator()(const StructureValue &lhs, const StructureValue &rhs) const
+    {
+        return lhs < rhs;
+    }
+    bool operator()(const std::unique_ptr<StructureValue> &lhs,
+                    const std::unique_ptr<StructureValue> &rhs) const
+    {
+        return *lhs < *rhs;
+    }
 };
+/** @} */
 }
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "structure/structure_export.h"
+
+#include "structure/value/StructureValue.hpp"
+#include "structure/value/SharedValue.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace structure
+{
+
+/** A value shared between one or more writers and concurrent readers
+ *
+ * Readers take a snapshot(): an immutable value that stays valid for as long as they hold it,
+ * regardless of later updates. Writers prepare a new version aside, without disturbing readers,
+ * then publish it by atomically bumping the version number.
+ *
+ * Taking a snapshot is lock-free: it only involves atomic counters (no mutex, including the one
+ * behind std::atomic_load of std::shared_ptr) and it only retries when a version is published
+ * meanwhile. Older versions are destroyed by writers, during a later publication or collect(),
+ * once no reader holds them anymore: readers never pay for freeing them.
+ *
+ * Example:
+ * @code
+ * VersionedValue parameters(root.with({...}));
+ *
+ * // Reader threads
+ * auto current = parameters.snapshot();
+ * binary_export::write(output, *current);
+ *
+ * // Control thread
+ * parameters.update(delta);
+ * @endcode
+ */
+class STRUCTURE_EXPORT VersionedValue
+{
+public:
+    /** An immutable version of the value */
+    using Snapshot = SharedValue;
+
+    /** @param[in] initial The first version of the value; must not be null */
+    explicit VersionedValue(std::unique_ptr<StructureValue> initial);
+
+    /** @returns the latest published version
+     *
+     * Never waits for writers; see the class description.
+     */
+    Snapshot snapshot() const;
+
+    /** @returns the number of versions published since construction */
+    uint64_t getVersion() const { return mVersion.load(); }
+
+    /** Replace the value with a new version
+     *
+     * @param[in] value The new version; must not be null
+     * @returns the published version
+     */
+    Snapshot publish(std::unique_ptr<StructureValue> value);
+
+    /** Publish a modified deep copy of the latest version
+     *
+     * The fields modified by `modify` are dirty in the published version (see
+     * StructureValue::isDirty()), so that readers can only browse what changed since the previous
+     * version. Writers are serialized so that no update is lost.
+     *
+     * @param[in] modify Called with a private copy of the latest version, to be modified in place.
+     *                   If it throws, nothing is published.
+     * @returns the published version
+     */
+    template <class Modifier>
+    Snapshot update(Modifier modify)
+    {
+        std::lock_guard<std::mutex> lock(mWriters);
+        auto next = snapshot()->clone();
+        modify(*next);
+        return doPublish(std::move(next));
+    }
+
+    /** Publish the latest version patched with a delta
+     *
+     * Unlike update(Modifier), the new version shares all the unchanged subtrees with the previous
+     * one. As with update(Modifier), only the modified fields are dirty in the published version.
+     *
+     * @see structure::patch(const SharedValue &, const Delta &)
+     */
+    Snapshot update(const Delta &delta);
+
+    /** Destroy the older versions that readers have dropped since the last publication
+     *
+     * Publications do it as well; this is for writers which rarely publish.
+     */
+    void collect();
+
+private:
+    /** Holds a version, while readers copy it */
+    struct Slot
+    {
+        Snapshot value;
+        /** The number of readers copying the value; writers don't replace it until it is 0 */
+        mutable std::atomic<uint32_t> readers{0};
+    };
+    /** Versions are stored in turn in each slot, so that a publication doesn't need to wait for
+     * the readers of the latest version, nor in practice for those of the previous ones.
+     */
+    static constexpr size_t slotCount = 4;
+
+    Snapshot doPublish(Snapshot value);
+    void doCollect();
+
+    std::array<Slot, slotCount> mSlots;
+    /** The latest version, stored in mSlots[mVersion % slotCount] */
+    std::atomic<uint64_t> mVersion{0};
+    /** The replaced versions which readers may still hold; only accessed by writers */
+    std::vector<Snapshot> mRetired;
+    /** Only taken by writers */
+    std::mutex mWriters;
+};
+} // namespace structure
@@ -29,6 +29,11 @@
 #include "structure/attributes/Range.hpp"
 #include "structure/type/stock.hpp"
 #include "structure/importer/DefaultImporter.hpp"
+#include "structure/importer/StreamImporter.hpp"
+#include "structure/functions.hpp"
+
+#include <iterator>
+#include <sstream>
 
 using namespace structure;
 
@@ -100,3 +105,68 @@ TEST_CASE("Default attributes", "[structure][default]")
     CHECK_NOTHROW(root.with({42, 3.14}));
     CHECK_THROWS(root.with({defaultImporter, defaultImporter}));
 }
+
+TEST_CASE("Default values", "[structure][default]")
+{
+    using attributes::Default;
+
+    Block root("root", UInt8("a", Default{42}), Q16f15("q", Default{0.5}),
+               Array("points", Block("point", Double("x", Default{"1.5"}), Int16("y", Default{-2})),
+                     3),
+               String("s", Default{"abc"}), VarArray("v", UInt8("i", Default{1})),
+               PrefixedArray<UInt8>("p", Bool("b", Default{true})));
+
+    // Items of the "points" array
+    auto point = [](const StructureValue &value, size_t index) -> StructureValue & {
+        const auto &points = dynamic_cast<BlockValue &>(getChild(value, "points"));
+        return **std::next(points.getFields().begin(), index);
+    };
+
+    auto value = root.buildDefault();
+    CHECK(getValue(getChild(*value, "a")) == "42");
+    CHECK(getValue(getChild(*value, "q")) == "16384");
+    CHECK(dynamic_cast<BlockValue &>(getChild(*value, "points")).getFields().size() == 3);
+    CHECK(getValue(getChild(point(*value, 2), "x")) == "1.500000");
+    CHECK(getValue(getChild(point(*value, 0), "y")) == "-2");
+    CHECK(getValue(getChild(*value, "s")) == "\"abc\"");
+    // Variable-length arrays are empty
+    CHECK(dynamic_cast<BlockValue &>(getChild(*value, "v")).getFields().empty());
+    CHECK(getValue(getChild(*value, "p/count")) == "0");
+
+    SECTION ("Building a value twice gives the same result") {
+        CHECK(*root.buildDefault() == *value);
+    }
+
+    SECTION ("Values do not share their storage") {
+        auto other = root.buildDefault();
+        dynamic_cast<GenericFieldValue &>(getChild(point(*other, 1), "y")).setStorage(Atom(3));
+        CHECK(getValue(getChild(point(*other, 0), "y")) == "-2");
+        CHECK(getValue(getChild(point(*other, 2), "y")) == "-2");
+        CHECK(getValue(getChild(point(*value, 1), "y")) == "-2");
+    }
+
+    SECTION ("The DefaultImporter gives the same values") {
+        Block fixed("root", UInt8("a", Default{42}), Q16f15("q", Default{0.5}),
+                    String("s", Default{"abc"}));
+        CHECK(*fixed.build(defaultImporter) == *fixed.buildDefault());
+    }
+
+    SECTION ("Fields without default") {
+        CHECK_THROWS_AS(Block("root", UInt8("a")).buildDefault(), NoDefaultValue &);
+        CHECK_THROWS_AS(UInt8("a").withDefault("a"), NoDefaultValue &);
+    }
+
+    SECTION ("Invalid defaults fail on each build") {
+        UInt8 invalid("a", attributes::mkRange(0, 10), Default{42});
+        CHECK_THROWS_AS(invalid.buildDefault(), std::range_error &);
+        CHECK_THROWS_AS(invalid.buildDefault(), std::range_error &);
+    }
+
+    SECTION ("Importers are not constant defaults") {
+        std::stringstream input("1 2");
+        StreamImporter<> importer(input);
+        UInt8 imported("a", Default{importer});
+        CHECK(getValue(*imported.buildDefault()) == "1");
+        CHECK(getValue(*imported.buildDefault()) == "2");
+    }
+}
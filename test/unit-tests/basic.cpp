@@ -27,10 +27,17 @@
 #include <catch.hpp>
 
 #include "structure/functions.hpp"
+#include "structure/SchemaSnapshot.hpp"
+#include "structure/importer/DefaultImporter.hpp"
 #include "structure/type/stock.hpp"
 #include "structure/detail/safe_cast.hpp"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace structure;
 
@@ -85,6 +92,251 @@ TEST_CASE("GetName", "[structure][value][name]")
     CHECK(Int32("name").with("42")->getName() == "name");
 }
 
+TEST_CASE("Interned names", "[structure][value][name]")
+{
+    Block block("interned", UInt8("a"), Block("b", UInt8("a")));
+    const auto &a = block.getFields()[0].get();
+    const auto &nestedA = getChild(block, "b/a");
+
+    // Equal names share their storage and their identifier
+    CHECK(&a.getName() == &nestedA.getName());
+    CHECK(a.getSymbol() == nestedA.getSymbol());
+    CHECK(a.getSymbol() == Symbol("a"));
+    CHECK(a.getSymbol() != block.getSymbol());
+    CHECK(Symbol().str().empty());
+    CHECK(Symbol() == Symbol(""));
+
+    // Values and copies refer to the same name
+    auto value = block.with({"1", {"2"}});
+    CHECK(&value->getName() == &block.getName());
+    CHECK(getChild(value, "b/a").getSymbol() == a.getSymbol());
+
+    Symbol found;
+    CHECK(Symbol::find("interned", found));
+    CHECK(found == block.getSymbol());
+    CHECK(not Symbol::find("never used as a name", found));
+    CHECK_THROWS_AS(getChild(block, "never used as a name"), ChildNotFound &);
+
+    // Lookups are lock-free, while new symbols are being interned concurrently
+    std::vector<std::thread> threads;
+    std::vector<std::vector<Symbol>> interned(4), looked(4);
+    for (size_t t = 0; t < interned.size(); ++t) {
+        threads.emplace_back([t, &interned, &looked] {
+            for (int i = 0; i < 1000; ++i) {
+                interned[t].emplace_back("symbol " + std::to_string(i));
+                looked[t].emplace_back();
+                Symbol::find(interned[t].back().str(), looked[t].back());
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (size_t t = 0; t < interned.size(); ++t) {
+        CHECK(interned[t] == interned.front());
+        CHECK(looked[t] == interned[t]);
+    }
+    CHECK(Symbol::find("symbol 999", found));
+    CHECK(found.str() == "symbol 999");
+}
+
+TEST_CASE("Kind tags", "[structure][kind]")
+{
+    Block block("block", UInt16("u16"), Q16f15("q"), Double("d"), FixedString<8>("fixed"),
+                Array("array", Bool("b"), 3), VarArray("var", String("s")),
+                PrefixedArray<UInt8>("prefixed", Int32("i")));
+    const auto &fields = block.getFields();
+
+    CHECK(block.getKind() == StructureKind::Block);
+    CHECK(block.getTraits().isBlock());
+
+    const auto &u16 = fields[0].get().getTraits();
+    CHECK(u16.kind == StructureKind::Integer);
+    CHECK(u16.size == 16);
+    CHECK(not u16.isSigned);
+
+    const auto &q = fields[1].get().getTraits();
+    CHECK(q.kind == StructureKind::FixedQ);
+    CHECK(q.size == 16);
+    CHECK(q.fractional == 15);
+    CHECK(q.isSigned);
+
+    const auto &d = fields[2].get().getTraits();
+    CHECK(d.kind == StructureKind::FloatingPoint);
+    CHECK(d.size == 64);
+
+    const auto &fixed = fields[3].get().getTraits();
+    CHECK(fixed.kind == StructureKind::FixedString);
+    CHECK(fixed.size == 8);
+    CHECK(not fixed.isBlock());
+
+    const auto &array = fields[4].get();
+    CHECK(array.getKind() == StructureKind::Array);
+    CHECK(array.getTraits().count == 3);
+    CHECK(getChild(array, "b").getKind() == StructureKind::Bool);
+
+    CHECK(fields[5].get().getKind() == StructureKind::VarArray);
+    CHECK(getChild(block, "var/s").getKind() == StructureKind::String);
+    CHECK(fields[6].get().getKind() == StructureKind::PrefixedArray);
+    CHECK(fields[6].get().getTraits().isBlock());
+
+    // Values refer to structures carrying the same tags
+    auto value = block.with({"1", "0.5", "2", "abc", {"1", "0", "1"}, {"x"}, {"1", {"7"}}});
+    CHECK(getChild(value, "u16").getStructure().getKind() == StructureKind::Integer);
+    CHECK(value->getStructure().getTraits().isBlock());
+}
+
+TEST_CASE("Schema snapshots", "[structure][snapshot]")
+{
+    using namespace attributes;
+    UInt16 u16("u16", mkRange(1, 1000), Default{10});
+    u16.setMetadata("unit", "ms");
+    Block schema("schema", Description{"The whole schema"}, Alignment{8}, std::move(u16),
+                 Int64("i64", Default{-5}, Alignment{8}), Double("d", Default{0.1}),
+                 Q16f15("q"), String("s", StringEncoding::prefixed(2), Default{"abc"}),
+                 FixedString<16>("fixed", MaxLength{10}), Bool("b", Default{true}),
+                 Array("array", Float("f", mkRange(-1.5, 1.5)), 3),
+                 PrefixedArray<Int32>("prefixed", UInt8("u8"), "size", Description{"items"}),
+                 VarArray("var", Block("item", UInt8("a"), String("name"))));
+    schema.setMetadata("version", "2");
+
+    auto snapshot = saveSchema(schema);
+    auto loaded = loadSchema(snapshot);
+
+    // Fingerprints cover types, names, attributes and metadata
+    REQUIRE(*loaded == schema);
+    CHECK(loaded->getDescription() == "The whole schema");
+    CHECK(getChild(*loaded, "u16").getMetadata().at("unit") == "ms");
+    CHECK(getChild(*loaded, "var").getTypeName() == "VarArray");
+    CHECK(getChild(*loaded, "prefixed").getTypeName() == "LV (Int32)");
+    CHECK(saveSchema(*loaded) == snapshot);
+
+    // Defaults are restored
+    auto &block = static_cast<const Block &>(*loaded);
+    auto value = block.with({defaultImporter, defaultImporter, defaultImporter, "0.5",
+                             defaultImporter, "hello", defaultImporter, {"1", "0", "-1"},
+                             {"1", {"2"}}, {{"1", "a"}}});
+    CHECK(getValue(getChild(value, "u16")) == "10");
+    CHECK(getValue(getChild(value, "i64")) == "-5");
+    CHECK(dynamic_cast<const GenericFieldValue &>(getChild(value, "d")).getStorage() == Atom(0.1));
+    CHECK(getValue(getChild(value, "s")) == "\"abc\"");
+    CHECK(getValue(getChild(value, "b")) == "1");
+
+    // Only stock types are supported
+    CHECK_THROWS_AS(saveSchema(Block("custom", NewInteger<8, false, uint16_t>("a"))),
+                    SchemaError &);
+    CHECK_THROWS_AS(saveSchema(FixedString<10>("fixed")), SchemaError &);
+
+    CHECK_THROWS_AS(loadSchema("not a snapshot"), SchemaError &);
+    CHECK_THROWS_AS(loadSchema(snapshot.substr(0, snapshot.size() - 1)), SchemaError &);
+    CHECK_THROWS_AS(loadSchema(snapshot + "x"), SchemaError &);
+}
+
+TEST_CASE("Prototypes", "[structure][value][clone]")
+{
+    auto makeSchema = [] {
+        return Block("root", UInt8("a"), String("s"), Array("array", Int16("i"), 2),
+                     PrefixedArray<UInt8>("prefixed", Float("f")),
+                     VarArray("var", Block("item", UInt8("b"), Double("d"))));
+    };
+    auto schema = makeSchema();
+    auto field = [](const StructureValue &value, const std::string &path) -> GenericFieldValue & {
+        return dynamic_cast<GenericFieldValue &>(getChild(value, path));
+    };
+    auto prototype =
+        schema.with({"1", "spam", {"2", "3"}, {"1", {"4.5"}}, {{"5", "6.5"}, {"7", "8.5"}}});
+
+    SECTION ("Clones are deep copies") {
+        auto copy = prototype->clone();
+        CHECK(*copy == *prototype);
+        CHECK(&copy->getStructure() == &schema);
+        CHECK(copy->getFieldCount() == prototype->getFieldCount());
+        CHECK(not copy->isDirty());
+
+        field(*copy, "s").setStorage(Atom("eggs"));
+        CHECK(copy->isDirty());
+        CHECK(getValue(getChild(prototype, "s")) == "\"spam\"");
+        CHECK(*copy != *prototype);
+
+        // Copies outlive their prototypes
+        prototype.reset();
+        CHECK(getValue(getChild(copy, "s")) == "\"eggs\"");
+        CHECK(getValue(copy->clone()) == getValue(copy));
+    }
+
+    SECTION ("Values can be instantiated from a prototype of an equal structure") {
+        auto other = makeSchema();
+        auto value = other.instantiateFrom(*prototype);
+        CHECK(*value == *prototype);
+        CHECK(&value->getStructure() == &other);
+        CHECK(&getChild(*value, "var").getStructure() == &getChild(other, "var"));
+        CHECK(value->getFieldCount() == 10);
+        CHECK(not value->isDirty());
+
+        // Children are attached to the returned block
+        field(*value, "a").setStorage(Atom(9));
+        CHECK(value->isDirty());
+        CHECK(getValue(getChild(value, "a")) == "9");
+        CHECK(getValue(getChild(prototype, "a")) == "1");
+
+        CHECK(getValue(schema.instantiateFrom(*value)) == getValue(value));
+        CHECK(getValue(UInt8("a").instantiateFrom(getChild(*prototype, "a"))) == "1");
+    }
+
+    SECTION ("The prototype must match the structure") {
+        CHECK_THROWS_AS(Block("root", UInt8("a")).instantiateFrom(*prototype),
+                        ValueStructureMismatch &);
+        CHECK_THROWS_AS(UInt16("a").instantiateFrom(getChild(*prototype, "a")),
+                        ValueStructureMismatch &);
+    }
+}
+
+TEST_CASE("Arenas", "[value][arena]")
+{
+    auto arena = std::make_shared<detail::Arena>();
+
+    SECTION ("Chunks grow up to a bounded size") {
+        std::vector<std::shared_ptr<detail::Arena::Chunk>> chunks;
+        for (int i = 0; i < 10000; ++i) {
+            auto chunk = arena->reserve(64, alignof(uint64_t));
+            chunk->allocate(64, alignof(uint64_t));
+            if (chunks.empty() or chunks.back() != chunk) {
+                chunks.push_back(chunk);
+            }
+        }
+        CHECK(chunks.size() > 5);
+        CHECK(chunks.front()->capacity() < chunks.back()->capacity());
+        CHECK(chunks.back()->capacity() == size_t{detail::Arena::maxChunkSize});
+    }
+
+    SECTION ("Nodes may outlive the rest of their tree") {
+        Block root("root", Array("items",
+                                 Block("item", UInt32("u", attributes::Default{7}),
+                                       String("s", attributes::Default{"spam"})),
+                                 10000));
+        auto value = root.buildDefault();
+        std::shared_ptr<StructureValue> survivor;
+        std::weak_ptr<StructureValue> other;
+        {
+            auto copy = value->clone();
+            const auto &items = static_cast<const BlockValue &>(*copy).getFields().front();
+            const auto &fields = static_cast<const BlockValue &>(*items).getFields();
+            survivor = fields.back();
+            other = fields.front();
+        }
+        CHECK(other.expired());
+        CHECK(getValue(*survivor) == R"({7, "spam"})");
+    }
+
+    SECTION ("Objects larger than a chunk get their own memory") {
+        auto large = detail::makeShared<std::array<char, 2 * detail::Arena::maxChunkSize>>(arena);
+        large->fill('x');
+        auto small = detail::makeShared<uint64_t>(arena, 42);
+        CHECK(large->back() == 'x');
+        CHECK(*small == 42);
+    }
+}
+
 TEST_CASE("Integer basic tests", "[structure][integer]")
 {
     CHECK(UInt32::fromString("5") == 5);
@@ -140,6 +392,31 @@ TEST_CASE("Boolean basic tests", "[structure][value][bool]")
     CHECK(b.with("0")->getValue() == "0");
 }
 
+TEST_CASE("FixedString basic tests", "[structure][value][string]")
+{
+    FixedString<8> s("s", attributes::MaxLength{6});
+
+    CHECK(s.getTypeName() == "FixedString8");
+    CHECK(s.getMaxLength() == 6);
+    CHECK(FixedString<8>("t").getMaxLength() == 8);
+    CHECK(s.getStringEncoding().mKind == attributes::StringEncoding::Kind::FixedCapacity);
+
+    auto value = s.with("spam");
+    CHECK(value->getValue() == "\"spam\"");
+    CHECK(value->getStorage() == Atom("spam"));
+
+    auto &typed = dynamic_cast<FieldValue<FixedString<8>> &>(*value);
+    CHECK(typed.getTypedValue().size() == 4);
+    CHECK(typed.getTypedValue() == InlineString<8>("spam"));
+    typed.setStorage(Atom("eggs"));
+    CHECK(typed.getTypedValue().str() == "eggs");
+
+    // Longer than the maximum length, then than the capacity
+    CHECK_THROWS_AS(s.with("bacons!"), std::range_error &);
+    CHECK_THROWS_AS(s.with("spam and eggs"), ParseError &);
+    CHECK_THROWS_AS(typed.setStorage(Atom("spam and eggs")), ParseError &);
+}
+
 TEST_CASE("Get Child", "[child]")
 {
     std::unique_ptr<Block> block(new Block("block", Float("child")));
@@ -302,3 +579,235 @@ TEST_CASE("Typed With", "[typed][value]")
     CHECK_THROWS(auto value = root.with({256, 3.14f, 0.01, "spam"}));
     CHECK_THROWS(auto value = root.with({255, 3.14f, 0.01, 42}));
 }
+
+TEST_CASE("Fingerprint", "[structure][fingerprint]")
+{
+    auto make = [] {
+        return Block("root", UInt8("a"), Array("b", Q16f15("q"), 3),
+                     Block("c", Float("f", attributes::mkRange(-1.0, 1.0))));
+    };
+    auto reference = make();
+
+    SECTION ("Identical definitions") {
+        CHECK(make().getFingerprint() == reference.getFingerprint());
+        CHECK(make() == reference);
+        CHECK(UInt8("a") == UInt8("a"));
+    }
+
+    SECTION ("Platform independence") {
+        // Only logical sizes are hashed: this must hold on every platform and compiler.
+        CHECK(reference.getFingerprint() == 0xfeebdfc627e4f4f);
+        CHECK(FixedString<4>("s").getFingerprint() == 0xb273f2cf73e9dee);
+    }
+
+    SECTION ("Different definitions") {
+        CHECK(Block("root", UInt8("b"), Array("b", Q16f15("q"), 3),
+                    Block("c", Float("f", attributes::mkRange(-1.0, 1.0)))) != reference);
+        CHECK(Block("root", Int8("a"), Array("b", Q16f15("q"), 3),
+                    Block("c", Float("f", attributes::mkRange(-1.0, 1.0)))) != reference);
+        CHECK(Block("root", UInt8("a"), Array("b", Q16f15("q"), 4),
+                    Block("c", Float("f", attributes::mkRange(-1.0, 1.0)))) != reference);
+        CHECK(Block("root", UInt8("a"), Array("b", Q32f31("q"), 3),
+                    Block("c", Float("f", attributes::mkRange(-1.0, 1.0)))) != reference);
+        CHECK(Block("root", UInt8("a"), Array("b", Q16f15("q"), 3),
+                    Block("c", Float("f", attributes::mkRange(-1.0, 2.0)))) != reference);
+        CHECK(Block("root", UInt8("a"), Array("b", Q16f15("q"), 3), Block("c", Float("f"))) !=
+              reference);
+        CHECK((NewInteger<8, false, uint16_t>("a") != UInt8("a")));
+        CHECK(PrefixedArray<UInt8>("a", UInt8("u")) != PrefixedArray<UInt16>("a", UInt8("u")));
+        CHECK(PrefixedArray<UInt8>("a", UInt8("u"), "n") != PrefixedArray<UInt8>("a", UInt8("u")));
+    }
+
+    SECTION ("Modified definitions") {
+        auto modified = make();
+        modified.setMetadata("key", "value");
+        CHECK(modified != reference);
+        auto other = make();
+        other.setMetadata("key", "other value");
+        CHECK(modified != other);
+        other.setMetadata("key", "value");
+        CHECK(modified == other);
+
+        modified.addChild(std::make_unique<Bool>("d"));
+        CHECK(modified != other);
+    }
+
+    SECTION ("Modified children") {
+        auto modified = make();
+        auto nested = std::make_unique<Block>("n", UInt8("x"));
+        auto &child = *nested;
+        modified.addChild(std::move(nested));
+        auto fingerprint = modified.getFingerprint();
+        auto size = modified.getLayout()->getSize();
+
+        child.setMetadata("key", "value");
+        CHECK(modified.getFingerprint() != fingerprint);
+        fingerprint = modified.getFingerprint();
+
+        // The children follow their block when it is moved.
+        auto moved = std::move(modified);
+        CHECK(moved.getFingerprint() == fingerprint);
+        CHECK(moved.getLayout()->getSize() == size);
+        child.addChild(std::make_unique<UInt16>("y"));
+        CHECK(moved.getFingerprint() != fingerprint);
+        CHECK(moved.getLayout()->getSize() == size + 2);
+    }
+}
+
+TEST_CASE("Dirty tracking", "[value][dirty]")
+{
+    Block root("root", UInt8("a"), Block("b", Float("f"), String("s")), Block("c", Bool("t")));
+    auto value = root.with({1, {0.5f, "spam"}, {true}});
+    auto &block = dynamic_cast<BlockValue &>(*value);
+    auto child = [](BlockValue &parent, size_t index) -> StructureValue & {
+        return *std::next(parent.getFields().begin(), index)->get();
+    };
+    auto &b = dynamic_cast<BlockValue &>(child(block, 1));
+    auto &s = dynamic_cast<FieldValue<String> &>(child(b, 1));
+
+    std::vector<std::string> visited;
+    auto visit = [&] {
+        visited.clear();
+        applyDirty(*value,
+                   [&](const BlockValue &v) { visited.push_back(v.getStructure().getName()); },
+                   [&](const BlockValue &) {},
+                   [&](const GenericFieldValue &v) {
+                       visited.push_back(v.getStructure().getName() + "=" + v.getValue());
+                   });
+        return visited;
+    };
+
+    SECTION ("New values are clean") {
+        CHECK(not value->isDirty());
+        CHECK(visit().empty());
+    }
+
+    SECTION ("Modifications propagate to the enclosing blocks") {
+        s.setTypedValue("eggs");
+        CHECK(s.isDirty());
+        CHECK(b.isDirty());
+        CHECK(value->isDirty());
+        CHECK(not child(block, 0).isDirty());
+        CHECK(not child(block, 2).isDirty());
+        CHECK(visit() == (std::vector<std::string>{"root", "b", "s=\"eggs\""}));
+
+        dynamic_cast<FieldValue<UInt8> &>(child(block, 0)).setValue("2");
+        CHECK(visit() == (std::vector<std::string>{"root", "a=2", "b", "s=\"eggs\""}));
+
+        SECTION ("Clearing a subtree") {
+            b.clearDirty();
+            CHECK(not s.isDirty());
+            CHECK(value->isDirty());
+            CHECK(visit() == (std::vector<std::string>{"root", "a=2"}));
+
+            s.setTypedValue("bacon");
+            CHECK(visit() == (std::vector<std::string>{"root", "a=2", "b", "s=\"bacon\""}));
+        }
+
+        SECTION ("Clearing everything") {
+            value->clearDirty();
+            CHECK(not value->isDirty());
+            CHECK(not s.isDirty());
+            CHECK(visit().empty());
+        }
+    }
+}
+
+TEST_CASE("Layout", "[structure][layout]")
+{
+    Block root("root", UInt8("a"), Array("b", Block("c", Int16("d"), Float("e")), 3), UInt32("f"));
+    auto layout = root.getLayout();
+    CHECK(root.getLayout() == layout);
+
+    SECTION ("Fixed-size structures") {
+        REQUIRE(layout->isFixedSize());
+        CHECK(layout->getSize() == 1 + 3 * (2 + 4) + 4);
+        CHECK(layout->getRoot().fieldCount == 8);
+
+        CHECK(layout->locate(0).offset == 0);
+        CHECK(layout->locate(0).field.getName() == "a");
+        CHECK(layout->locate(3).offset == 1 + 6);
+        CHECK(layout->locate(3).field.getName() == "d");
+        CHECK(layout->locate(4).offset == 1 + 6 + 2);
+        CHECK(layout->locate(4).field.getName() == "e");
+        CHECK(layout->locate(7).offset == 1 + 18);
+        CHECK(layout->locate(7).field.getName() == "f");
+        CHECK_THROWS_AS(layout->locate(8), std::out_of_range &);
+    }
+
+    SECTION ("Variable-size structures") {
+        root.addChild(std::make_unique<VarArray>("g", UInt8("h")));
+        auto variable = root.getLayout();
+        CHECK(variable != layout);
+        CHECK(not variable->isFixedSize());
+        CHECK_THROWS_AS(variable->locate(0), std::logic_error &);
+
+        // Fixed-size subtrees are still known as such
+        const auto &b = root.getFields()[1].get();
+        CHECK(variable->at(b).size == 18);
+        CHECK(variable->at(b).count == 3);
+        CHECK(Block("s", String("s")).getLayout()->getRoot().size == Layout::variable);
+    }
+}
+
+namespace
+{
+// The C equivalent of the block of the "Aligned layouts" test case
+struct Item
+{
+    int16_t d;
+    float e;
+};
+struct Root
+{
+    uint8_t a;
+    Item b[3];
+    uint8_t f;
+    double g;
+    uint16_t h;
+};
+}
+
+TEST_CASE("Aligned layouts", "[structure][layout]")
+{
+    Block root("root", UInt8("a"), Array("b", Block("c", Int16("d"), Float("e")), 3), UInt8("f"),
+               Double("g"), UInt16("h"));
+
+    SECTION ("Natural alignment matches C structs") {
+        auto layout = root.getLayout(LayoutPolicy::Natural);
+        CHECK(layout != root.getLayout());
+        CHECK(layout == root.getLayout(LayoutPolicy::Natural));
+        CHECK(layout->getPolicy() == LayoutPolicy::Natural);
+
+        REQUIRE(layout->isFixedSize());
+        CHECK(layout->getSize() == sizeof(Root));
+        CHECK(layout->getRoot().alignment == alignof(Root));
+        std::vector<size_t> offsets{offsetof(Root, a), offsetof(Root, b), offsetof(Root, f),
+                                    offsetof(Root, g), offsetof(Root, h)};
+        CHECK(layout->getRoot().offsets == offsets);
+        CHECK(layout->locate(4).offset == offsetof(Root, b) + sizeof(Item) + offsetof(Item, e));
+        CHECK(layout->locate(7).offset == offsetof(Root, f));
+    }
+
+    SECTION ("Alignment attributes") {
+        Block aligned("aligned", UInt8("a"), UInt8("b", attributes::Alignment{4}),
+                      Block("c", UInt8("d"), attributes::Alignment{8}));
+
+        auto natural = aligned.getLayout(LayoutPolicy::Natural);
+        CHECK(natural->getRoot().offsets == (std::vector<size_t>{0, 4, 8}));
+        CHECK(natural->getSize() == 16);
+
+        // Only structures with an attribute are aligned
+        auto explicitly = aligned.getLayout(LayoutPolicy::Explicit);
+        CHECK(explicitly->getRoot().offsets == (std::vector<size_t>{0, 4, 8}));
+        CHECK(explicitly->getSize() == 16);
+        CHECK(root.getLayout(LayoutPolicy::Explicit)->getSize() == root.getLayout()->getSize());
+
+        // Packed layouts ignore attributes
+        CHECK(aligned.getLayout()->getSize() == 3);
+
+        CHECK(aligned.getFingerprint() !=
+              Block("aligned", UInt8("a"), UInt8("b"), Block("c", UInt8("d"))).getFingerprint());
+        CHECK_THROWS_AS(UInt8("x", attributes::Alignment{3}), std::invalid_argument &);
+    }
+}
@@ -28,6 +28,16 @@
 
 #include "structure/type/stock.hpp"
 #include "BinaryExport.hpp"
+#include "ParallelExport.hpp"
+#include "BinaryImport.hpp"
+#include "View.hpp"
+#include "BinaryPatch.hpp"
+#include "StreamExport.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
 
 namespace structure
 {
@@ -71,4 +81,541 @@ SCENARIO("Binary export", "[export][value][binary]")
         }
     }
 }
+
+SCENARIO("Parallel binary export", "[export][value][binary][parallel]")
+{
+    auto type = Block("root", Array("array", Block("item", UInt8("u8"), Int16("i16")), 3),
+                      VarArray("strings", String("s")), Float("f"));
+    auto value = type.with({{{"1", "-2"}, {"3", "-4"}, {"5", "-6"}}, {"egg", "spam"}, "1.5"});
+
+    binary_export::Visitor::Output expected;
+    binary_export::write(expected, *value);
+
+    GIVEN ("A value with nested arrays") {
+        THEN ("Exporting it with several jobs should produce the same result as a single job") {
+            for (unsigned jobs : {1, 2, 3, 8, 64}) {
+                binary_export::Visitor::Output actual;
+                binary_export::write(actual, *value, jobs);
+                CHECK(actual == expected);
+            }
+        }
+    }
+
+    GIVEN ("A value with a prefixed array of encoded strings") {
+        auto prefixed = Block("r", PrefixedArray<UInt8>("lv", FixedString<4>("s")), UInt8("a"),
+                              UInt8("b"));
+        auto lv = prefixed.with({{"3", {"x", "yy", "zzz"}}, "1", "2"});
+        binary_export::Visitor::Output sequential;
+        binary_export::write(sequential, *lv);
+        REQUIRE(sequential.size() == 15);
+
+        THEN ("Prefixed arrays should be exported whole") {
+            for (unsigned jobs : {1, 2, 8}) {
+                binary_export::Visitor::Output actual;
+                binary_export::write(actual, *lv, jobs);
+                CHECK(actual == sequential);
+            }
+        }
+    }
+
+    GIVEN ("A layout policy and a byte order") {
+        THEN ("They should be honoured as by a single job") {
+            auto big = binary_export::Endianness::Big;
+            for (auto policy : {LayoutPolicy::Packed, LayoutPolicy::Natural}) {
+                binary_export::Visitor::Output sequential;
+                for (int i = 0; i < 3; ++i) {
+                    binary_export::write(sequential, *value, policy, big);
+                }
+
+                binary_export::Visitor::Output actual;
+                binary_export::write(actual, *value, 3, policy, big);
+                // Padding is relative to the start of each value, even in a shared buffer
+                binary_export::write(actual, {*value, *value}, 1, policy, big);
+                CHECK(actual == sequential);
+            }
+        }
+    }
+
+    GIVEN ("Several independent values") {
+        auto other = type.with({{{"7", "8"}, {"9", "10"}, {"11", "12"}}, {}, "-0.5"});
+        binary_export::Visitor::Output sequential;
+        binary_export::write(sequential, *value);
+        binary_export::write(sequential, *other);
+        binary_export::write(sequential, *value);
+
+        THEN ("Exporting them concurrently should concatenate their exports in order") {
+            binary_export::Visitor::Output actual = {0xff};
+            binary_export::write(actual, {*value, *other, *value}, 2);
+            CHECK(actual.size() == sequential.size() + 1);
+            CHECK(std::equal(begin(sequential), end(sequential), begin(actual) + 1));
+        }
+    }
+
+    GIVEN ("Nothing to export") {
+        THEN ("Exporting it concurrently should leave the output untouched") {
+            binary_export::Visitor::Output actual = {0xff};
+            binary_export::write(actual, binary_export::Values{}, 4);
+            CHECK(actual == binary_export::Visitor::Output{0xff});
+
+            auto emptyArray = VarArray("empty", UInt8("u8"));
+            auto empty = emptyArray.with({});
+            binary_export::write(actual, *empty, 4);
+            CHECK(actual == binary_export::Visitor::Output{0xff});
+        }
+    }
+}
+
+SCENARIO("Binary views", "[export][import][value][binary][view]")
+{
+    auto type = Block("root", UInt8("u8"),
+                      Array("array", Block("item", Int16("i16"), Float("f")), 3), String("s"),
+                      PrefixedArray<UInt8>("lv", UInt32("u32")),
+                      VarArray("tail", Block("t", String("name"), Double("d"))));
+    auto value = type.with({"42",
+                            {{"-1", "0.5"}, {"-2", "1.5"}, {"-3", "2.5"}},
+                            "spam",
+                            {"2", {"100000", "200000"}},
+                            {{"egg", "0.25"}, {"bacon", "-8"}}});
+    binary_export::Visitor::Output bytes;
+    binary_export::write(bytes, *value);
+
+    GIVEN ("A view over an exported value") {
+        binary_export::View view(type, bytes);
+        CHECK(view.size() == bytes.size());
+
+        THEN ("Fields should be readable at any depth") {
+            CHECK(view.get<uint8_t>("u8") == 42);
+            CHECK(view.get<int16_t>("array/2/i16") == -3);
+            CHECK(view.get<float>("array/1/f") == 1.5);
+            CHECK(view.get<std::string>("s") == "spam");
+            CHECK(view.get<uint8_t>("lv/count") == 2);
+            CHECK(view.get<uint32_t>("lv/1") == 200000);
+            CHECK(view.get<std::string>("tail/1/name") == "bacon");
+            CHECK(view.get<double>("tail/1/d") == -8);
+            CHECK(view.getChild("tail/0/d").getStorage() == Atom(0.25));
+        }
+
+        THEN ("Views should have as many children as values") {
+            CHECK(view.getFields().size() == 5);
+            CHECK(view.getChild("array").getFields().size() == 3);
+            CHECK(view.getChild("lv").getFields().size() == 3);
+            CHECK(view.getChild("tail").getFields().size() == 2);
+        }
+
+        THEN ("Invalid accesses should throw") {
+            CHECK_THROWS_AS(view.get<int32_t>("u8"), ValueStructureMismatch &);
+            CHECK_THROWS_AS(view.get<int32_t>("array"), ValueStructureMismatch &);
+            CHECK_THROWS_AS(view.getChild("array/3"), ChildNotFound &);
+            CHECK_THROWS_AS(view.getChild("lv/2"), ChildNotFound &);
+            CHECK_THROWS_AS(view.getChild("tail/2"), ChildNotFound &);
+            CHECK_THROWS_AS(view.getChild("array/1x"), ChildNotFound &);
+            CHECK_THROWS_AS(view.getChild("array/0x1"), ChildNotFound &);
+            CHECK_THROWS_AS(view.getChild("lv/99999999999999999999999"), ChildNotFound &);
+            CHECK_THROWS_AS(view.getChild("spam"), ChildNotFound &);
+            CHECK_THROWS_AS(view.getChild("u8").getFields(), NotABlock &);
+        }
+
+        THEN ("Visiting the view should be equivalent to visiting the value") {
+            binary_export::Visitor::Output exported;
+            binary_export::Visitor visitor(exported);
+            view.accept(visitor);
+            CHECK(exported == bytes);
+        }
+
+        THEN ("The view should be convertible back to a value") {
+            CHECK(*view.materialize() == *value);
+            CHECK(*view.getChild("array/1").materialize() ==
+                  *Block("item", Int16("i16"), Float("f")).with({"-2", "1.5"}));
+        }
+    }
+
+    GIVEN ("Truncated data") {
+        auto fixed = Block("fixed", UInt32("a"), Array("b", Int16("c"), 2));
+        binary_export::Visitor::Output truncated;
+        binary_export::write(truncated, *fixed.with({"1", {"2", "3"}}));
+        truncated.pop_back();
+
+        THEN ("Views and imports should detect it") {
+            CHECK_THROWS_AS(binary_export::View(fixed, truncated), ValueStructureMismatch &);
+            CHECK_THROWS_AS(binary_export::read(fixed, truncated), ValueStructureMismatch &);
+            truncated.push_back(0);
+            truncated.push_back(0);
+            CHECK_THROWS_AS(binary_export::read(fixed, truncated), ValueStructureMismatch &);
+        }
+    }
+
+    GIVEN ("Exported bytes") {
+        THEN ("They should be imported back into an equal value") {
+            CHECK(*binary_export::read(type, bytes) == *value);
+        }
+    }
+}
+
+SCENARIO("Binary patch", "[export][value][binary][delta]")
+{
+    auto type = Block("root", UInt8("a"), Array("b", Block("c", Int16("d"), Double("e")), 2),
+                      Q16f15("q"));
+    auto before = type.with({"1", {{"-1", "0.5"}, {"-2", "1.5"}}, "0.25"});
+    auto after = type.with({"1", {{"-1", "0.5"}, {"-20000", "1.5"}}, "-0.5"});
+
+    binary_export::Visitor::Output expected;
+    binary_export::write(expected, *after);
+
+    GIVEN ("An exported value") {
+        binary_export::Visitor::Output bytes;
+        binary_export::write(bytes, *before);
+
+        THEN ("Patching it should be equivalent to exporting the modified value") {
+            binary_export::patch(type, bytes, diff(*before, *after));
+            CHECK(bytes == expected);
+        }
+
+        THEN ("Invalid patches should be rejected") {
+            Delta unexisting(type.getFingerprint());
+            unexisting.add(6, Atom(0), Atom(1));
+            CHECK_THROWS_AS(binary_export::patch(type, bytes, unexisting),
+                            ValueStructureMismatch &);
+            CHECK_THROWS_AS(binary_export::patch(type, bytes, Delta(0)), ValueStructureMismatch &);
+
+            Delta overflow(type.getFingerprint());
+            overflow.add(0, Atom(1), Atom(256));
+            CHECK_THROWS_AS(binary_export::patch(type, bytes, overflow), ParseError &);
+
+            // Valid changes preceding an invalid one must not be applied either
+            Delta partial(type.getFingerprint());
+            partial.add(0, Atom(1), Atom(2));
+            partial.add(3, Atom(-2), Atom(100000));
+            auto unpatched = bytes;
+            CHECK_THROWS_AS(binary_export::patch(type, bytes, partial), ParseError &);
+            CHECK(bytes == unpatched);
+
+            bytes.pop_back();
+            CHECK_THROWS_AS(binary_export::patch(type, bytes, diff(*before, *after)),
+                            ValueStructureMismatch &);
+        }
+    }
+
+    GIVEN ("A variable-size structure") {
+        auto variable = Block("root", String("s"));
+        binary_export::Visitor::Output bytes;
+        binary_export::write(bytes, *variable.with({"spam"}));
+
+        THEN ("It can't be patched in place") {
+            CHECK_THROWS_AS(binary_export::patch(variable, bytes, Delta(variable.getFingerprint())),
+                            ValueStructureMismatch &);
+        }
+    }
+}
+
+namespace
+{
+// The C equivalent of the fixed-size block of the "Aligned binary export" scenario
+struct Packet
+{
+    uint8_t a;
+    uint32_t b;
+    int16_t c[2];
+    double d;
+};
+}
+
+SCENARIO("Aligned binary export", "[export][import][value][binary][layout]")
+{
+    auto packet = Block("packet", UInt8("a"), UInt32("b"), Array("c", Int16("i"), 2), Double("d"));
+    auto value = packet.with({"1", "100000", {"-1", "-2"}, "0.5"});
+
+    GIVEN ("A fixed-size value exported with natural alignment") {
+        binary_export::Visitor::Output bytes;
+        binary_export::write(bytes, *value, LayoutPolicy::Natural);
+
+        THEN ("It should be laid out like the equivalent C struct") {
+            Packet expected;
+            std::memset(&expected, 0, sizeof(expected));
+            expected.a = 1;
+            expected.b = 100000;
+            expected.c[0] = -1;
+            expected.c[1] = -2;
+            expected.d = 0.5;
+
+            REQUIRE(bytes.size() == sizeof(expected));
+            CHECK(std::memcmp(bytes.data(), &expected, sizeof(expected)) == 0);
+        }
+
+        THEN ("It should be imported back into an equal value") {
+            CHECK(*binary_export::read(packet, bytes, LayoutPolicy::Natural) == *value);
+            CHECK_THROWS_AS(binary_export::read(packet, bytes), ValueStructureMismatch &);
+        }
+
+        THEN ("It should be patched at aligned offsets") {
+            auto after = packet.with({"1", "100000", {"-1", "-20"}, "4"});
+            binary_export::patch(packet, bytes, diff(*value, *after), LayoutPolicy::Natural);
+
+            binary_export::Visitor::Output expected;
+            binary_export::write(expected, *after, LayoutPolicy::Natural);
+            CHECK(bytes == expected);
+        }
+    }
+
+    GIVEN ("A variable-size value exported with natural alignment") {
+        auto type = Block("root", UInt8("u8"), String("s"),
+                          PrefixedArray<UInt8>("lv", UInt32("u32")),
+                          VarArray("tail", Block("t", String("name"), Double("d"))));
+        auto variable = type.with({"42", "spam", {"2", {"1", "2"}}, {{"egg", "0.25"}}});
+
+        binary_export::Visitor::Output bytes{0xff};
+        binary_export::write(bytes, *variable, LayoutPolicy::Natural);
+
+        THEN ("Padding should be relative to the start of the value") {
+            // The leading byte, then: u8, s, padding, prefix, padding, 2 items, padding, name,
+            // padding, d
+            CHECK(bytes.size() == 1 + (1 + 5 + 2 + 1 + 3 + 8 + 4 + 4 + 4 + 8));
+        }
+
+        THEN ("It should be imported back into an equal value") {
+            bytes.erase(bytes.begin());
+            CHECK(*binary_export::read(type, bytes, LayoutPolicy::Natural) == *variable);
+        }
+    }
+}
+
+SCENARIO("Endianness-aware binary export", "[export][import][value][binary][endianness]")
+{
+    using binary_export::Endianness;
+    using Bytes = binary_export::Visitor::Output;
+
+    auto fixed = Block("fixed", UInt16("a"), Array("b", UInt32("i"), 2), Int8("c"), Double("d"));
+    auto value = fixed.with({"258", {"16909060", "84281096"}, "-1", "0.5"});
+
+    auto variable = Block("variable", String("s"), VarArray("v", UInt16("u")));
+    auto variableValue = variable.with({"ab", {"258", "772"}});
+
+    GIVEN ("Values exported in big and little endian") {
+        Bytes big;
+        Bytes little;
+        binary_export::write(big, *value, LayoutPolicy::Packed, Endianness::Big);
+        binary_export::write(little, *value, LayoutPolicy::Packed, Endianness::Little);
+
+        THEN ("Scalars should be laid out in the requested byte order") {
+            CHECK((Bytes(big.begin(), big.begin() + 11) ==
+                   Bytes{0x01, 0x02, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0xff}));
+            CHECK((Bytes(little.begin(), little.begin() + 11) ==
+                   Bytes{0x02, 0x01, 0x04, 0x03, 0x02, 0x01, 0x08, 0x07, 0x06, 0x05, 0xff}));
+            CHECK(Bytes(big.rbegin(), big.rbegin() + 8) == Bytes(little.end() - 8, little.end()));
+
+            Bytes host;
+            binary_export::write(host, *value);
+            CHECK((host == big or host == little));
+        }
+
+        THEN ("They should be imported back into equal values") {
+            CHECK(*binary_export::read(fixed, big, LayoutPolicy::Packed, Endianness::Big) ==
+                  *value);
+            CHECK(*binary_export::read(fixed, little, LayoutPolicy::Packed, Endianness::Little) ==
+                  *value);
+        }
+
+        THEN ("They should be patched in their byte order") {
+            auto after = fixed.with({"258", {"16909060", "1"}, "-1", "0.5"});
+            binary_export::patch(fixed, big, diff(*value, *after), LayoutPolicy::Packed,
+                                 Endianness::Big);
+            CHECK((Bytes(big.begin() + 6, big.begin() + 10) == Bytes{0, 0, 0, 1}));
+            CHECK(*binary_export::read(fixed, big, LayoutPolicy::Packed, Endianness::Big) ==
+                  *after);
+        }
+    }
+
+    GIVEN ("A variable-size value exported in big endian with natural alignment") {
+        Bytes big;
+        binary_export::write(big, *variableValue, LayoutPolicy::Natural, Endianness::Big);
+
+        THEN ("Scalars should be swapped one by one") {
+            CHECK((big == Bytes{'a', 'b', 0, 0, 0x01, 0x02, 0x03, 0x04}));
+            CHECK(*binary_export::read(variable, big, LayoutPolicy::Natural, Endianness::Big) ==
+                  *variableValue);
+        }
+    }
+}
+
+SCENARIO("Streaming binary export", "[export][value][binary][stream]")
+{
+    using Bytes = binary_export::Visitor::Output;
+
+    auto type = Block("root", UInt32("a"), VarArray("v", Block("item", String("s"), Double("d"))));
+    auto value = type.with({"1",
+                            {{"short", "0.5"}, {std::string(100, 'x'), "1.5"}, {"", "2.5"}}});
+
+    Bytes expected;
+    binary_export::write(expected, *value, LayoutPolicy::Natural, binary_export::Endianness::Big);
+
+    GIVEN ("A value exported to a stream through a small buffer") {
+        std::stringstream stream;
+        binary_export::StreamVisitor visitor(stream, binary_export::Endianness::Big, 32);
+        binary_export::detail::writeValue(visitor, *type.getLayout(LayoutPolicy::Natural),
+                                          *value);
+
+        THEN ("Nothing should be output past the buffered bytes until it is flushed") {
+            auto beforeFlush = stream.str().size();
+            CHECK(beforeFlush < expected.size());
+            CHECK(expected.size() - beforeFlush <= 32);
+
+            visitor.flush();
+            auto actual = stream.str();
+            CHECK(Bytes(begin(actual), end(actual)) == expected);
+        }
+    }
+
+    GIVEN ("A value exported to a stream") {
+        std::stringstream stream;
+        binary_export::write(stream, *value, LayoutPolicy::Natural,
+                             binary_export::Endianness::Big);
+
+        THEN ("The output should be the same as with an in-memory export") {
+            auto actual = stream.str();
+            CHECK(Bytes(begin(actual), end(actual)) == expected);
+        }
+    }
+
+#ifdef BINARY_EXPORT_HAS_FD
+    GIVEN ("A value exported to a file descriptor") {
+        auto file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        auto fd = fileno(file);
+        binary_export::write(fd, *value, LayoutPolicy::Natural, binary_export::Endianness::Big);
+
+        THEN ("The file should hold the same bytes as an in-memory export") {
+            Bytes actual(expected.size() + 1);
+            REQUIRE(lseek(fd, 0, SEEK_SET) == 0);
+            auto size = read(fd, actual.data(), actual.size());
+            REQUIRE(size >= 0);
+            actual.resize(static_cast<size_t>(size));
+            CHECK(actual == expected);
+        }
+        std::fclose(file);
+    }
+#endif
+}
+
+SCENARIO("String encodings", "[export][import][value][binary][string]")
+{
+    using Bytes = binary_export::Visitor::Output;
+    using attributes::StringEncoding;
+
+    auto type = Block("root", String("nul"), String("varint", StringEncoding::varint()),
+                      String("prefixed", StringEncoding::prefixed(2)),
+                      String("fixed", StringEncoding::fixedCapacity(8)), UInt8("end"));
+    auto value = type.with({"a", std::string(200, 'v'), "pp", "fix", "7"});
+
+    GIVEN ("A value with various string encodings") {
+        Bytes bytes;
+        binary_export::write(bytes, *value, LayoutPolicy::Packed, binary_export::Endianness::Big);
+
+        THEN ("Each string should be laid out according to its encoding") {
+            REQUIRE(bytes.size() == 2 + (2 + 200) + (2 + 2) + 8 + 1);
+            CHECK((Bytes(bytes.begin() + 2, bytes.begin() + 4) == Bytes{0xc8, 0x01}));
+            CHECK((Bytes(bytes.begin() + 204, bytes.begin() + 208) == Bytes{0, 2, 'p', 'p'}));
+            CHECK((Bytes(bytes.begin() + 208, bytes.begin() + 216) ==
+                   Bytes{'f', 'i', 'x', 0, 0, 0, 0, 0}));
+        }
+
+        THEN ("It should be imported back into an equal value") {
+            CHECK(*binary_export::read(type, bytes, LayoutPolicy::Packed,
+                                       binary_export::Endianness::Big) == *value);
+        }
+
+        THEN ("Views should skip strings without scanning them") {
+            Bytes host;
+            binary_export::write(host, *value);
+            binary_export::View view(type, host);
+            CHECK(view.get<std::string>("varint") == std::string(200, 'v'));
+            CHECK(view.get<std::string>("fixed") == "fix");
+            CHECK(view.get<uint8_t>("end") == 7);
+        }
+    }
+
+    GIVEN ("A block whose strings have a fixed capacity") {
+        auto fixed = Block("fixed", UInt16("id"), String("name", StringEncoding::fixedCapacity(6)));
+        auto before = fixed.with({"1", "spam"});
+        auto after = fixed.with({"1", "bacon"});
+
+        THEN ("Its layout should have a fixed size") {
+            auto layout = fixed.getLayout(LayoutPolicy::Natural);
+            REQUIRE(layout->isFixedSize());
+            CHECK(layout->getSize() == 8);
+        }
+
+        THEN ("Its exports should be patchable in place") {
+            Bytes bytes;
+            binary_export::write(bytes, *before);
+            binary_export::patch(fixed, bytes, diff(*before, *after));
+
+            Bytes expected;
+            binary_export::write(expected, *after);
+            CHECK(bytes == expected);
+            CHECK(*binary_export::read(fixed, bytes) == *after);
+        }
+
+        THEN ("Strings exceeding the capacity should be rejected") {
+            CHECK_THROWS_AS(fixed.with({"1", "eggs and spam"}), std::range_error &);
+            CHECK_THROWS_AS(String("s", StringEncoding::prefixed(1)).with(std::string(256, 's')),
+                            std::range_error &);
+        }
+    }
+
+    THEN ("Encodings should be part of the fingerprint") {
+        CHECK(String("s", StringEncoding::varint()).getFingerprint() !=
+              String("s").getFingerprint());
+        CHECK(String("s", StringEncoding::nulTerminated()).getFingerprint() ==
+              String("s").getFingerprint());
+        CHECK_THROWS_AS(String("s", StringEncoding::prefixed(3)), std::invalid_argument &);
+    }
+}
+
+SCENARIO("Fixed strings in binary exports", "[export][import][value][binary][string]")
+{
+    using Bytes = binary_export::Visitor::Output;
+
+    auto type = Block("device", UInt16("id"), FixedString<8>("name"), Float("f"));
+    auto value = type.with({"1", "probe", "0.5"});
+
+    GIVEN ("A block holding a fixed string") {
+        THEN ("Its layout should have a fixed size") {
+            auto layout = type.getLayout(LayoutPolicy::Natural);
+            REQUIRE(layout->isFixedSize());
+            CHECK(layout->getSize() == 16);
+            CHECK(layout->getRoot().offsets == (std::vector<size_t>{0, 2, 12}));
+        }
+
+        Bytes bytes;
+        binary_export::write(bytes, *value, LayoutPolicy::Natural, binary_export::Endianness::Big);
+
+        THEN ("The string should be padded to its capacity and never byte-swapped") {
+            REQUIRE(bytes.size() == 16);
+            CHECK((Bytes(bytes.begin() + 2, bytes.begin() + 10) ==
+                   Bytes{'p', 'r', 'o', 'b', 'e', 0, 0, 0}));
+            CHECK(*binary_export::read(type, bytes, LayoutPolicy::Natural,
+                                       binary_export::Endianness::Big) == *value);
+        }
+
+        THEN ("It should be patchable in place") {
+            auto after = type.with({"1", "sensor42", "0.5"});
+            binary_export::patch(type, bytes, diff(*value, *after), LayoutPolicy::Natural,
+                                 binary_export::Endianness::Big);
+            CHECK((Bytes(bytes.begin() + 2, bytes.begin() + 10) ==
+                   Bytes{'s', 'e', 'n', 's', 'o', 'r', '4', '2'}));
+            CHECK(*binary_export::read(type, bytes, LayoutPolicy::Natural,
+                                       binary_export::Endianness::Big) == *after);
+        }
+    }
+
+    GIVEN ("A view over a packed export") {
+        Bytes bytes;
+        binary_export::write(bytes, *value);
+        binary_export::View view(type, bytes);
+
+        THEN ("The string should be readable in place") {
+            CHECK(view.get<InlineString<8>>("name") == InlineString<8>("probe"));
+            CHECK(view.get<float>("f") == 0.5);
+        }
+    }
+}
 } // namespace structure
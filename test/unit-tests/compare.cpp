@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <catch.hpp>
+
+#include "structure/functions.hpp"
+#include "structure/type/stock.hpp"
+
+#include <limits>
+#include <set>
+#include <unordered_set>
+
+using namespace structure;
+
+SCENARIO("Value comparison", "[value][compare]")
+{
+    Block root("root", Float("f"), VarArray("va", UInt8("u")), String("s"), Bool("b"));
+
+    GIVEN ("Values of the same structure") {
+        auto value = root.with({"1.5", {"1", "2"}, "spam", "true"});
+
+        THEN ("Values holding the same data should be equal and have the same hash") {
+            auto same = root.with({"1.5", {"1", "2"}, "spam", "true"});
+            CHECK(*value == *same);
+            CHECK_FALSE(*value != *same);
+            CHECK_FALSE(*value < *same);
+            CHECK(hash(*value) == hash(*same));
+        }
+
+        THEN ("Values holding different data should be different and ordered") {
+            auto other = root.with({"1.5", {"1", "3"}, "spam", "true"});
+            CHECK(*value != *other);
+            CHECK(*value < *other);
+            CHECK(*other > *value);
+            CHECK(hash(*value) != hash(*other));
+
+            auto shorter = root.with({"1.5", {"1"}, "spam", "true"});
+            CHECK(*shorter < *value);
+
+            auto string = root.with({"1.5", {"1", "2"}, "egg", "true"});
+            CHECK(*string < *value);
+        }
+
+        THEN ("Arrays should be told apart regardless of how their items are split") {
+            Block nested("root", VarArray("va1", UInt8("u")), VarArray("va2", UInt8("u")));
+            auto lhs = nested.with({{"1", "2"}, {"3"}});
+            auto rhs = nested.with({{"1"}, {"2", "3"}});
+            CHECK(*lhs != *rhs);
+            CHECK(hash(*lhs) != hash(*rhs));
+        }
+    }
+
+    GIVEN ("Floating point values") {
+        Double d("d");
+        auto nan = std::numeric_limits<double>::quiet_NaN();
+
+        THEN ("Zeros should be equal regardless of their sign") {
+            CHECK(*with(d, 0.0) == *with(d, -0.0));
+            CHECK(hash(*with(d, 0.0)) == hash(*with(d, -0.0)));
+        }
+        THEN ("NaNs should be equal to each other and greater than any other number") {
+            // NaNs can't be imported, they can only be set
+            auto lhs = with(d, 0.0);
+            lhs->setTypedValue(nan);
+            auto rhs = with(d, 1.0);
+            CHECK(*rhs < *lhs);
+            rhs->setTypedValue(nan);
+            CHECK(*lhs == *rhs);
+        }
+    }
+
+    GIVEN ("Fixed strings") {
+        Block fixed("root", FixedString<16>("a"), FixedString<16>("b"));
+
+        THEN ("They should be compared by content, then by size") {
+            auto value = fixed.with({"spam", "eggs and spam"});
+            CHECK(*value == *fixed.with({"spam", "eggs and spam"}));
+            CHECK(*value < *fixed.with({"spam", "eggs and spam!"}));
+            CHECK(*value > *fixed.with({"spam", "eggs and"}));
+            CHECK(*value > *fixed.with({"egg", "eggs and spam"}));
+            CHECK(*value < *fixed.with({"spam", "spam"}));
+            CHECK(hash(*value) == hash(*fixed.with({"spam", "eggs and spam"})));
+        }
+    }
+
+    GIVEN ("Values of different structures") {
+        THEN ("They should never be equal") {
+            CHECK(*UInt8("a").with("1") != *UInt8("b").with("1"));
+            CHECK(*UInt8("a").with("1") != *UInt16("a").with("1"));
+            CHECK((*UInt8("a").with("1") < *UInt8("b").with("1")) !=
+                  (*UInt8("b").with("1") < *UInt8("a").with("1")));
+        }
+    }
+
+    GIVEN ("Containers of values") {
+        THEN ("Duplicates should be detected") {
+            std::unordered_set<std::unique_ptr<StructureValue>, ValueHash, ValueEqual> unordered;
+            std::set<std::unique_ptr<StructureValue>, ValueLess> ordered;
+            for (auto data : {"1", "2", "1", "3", "2"}) {
+                unordered.insert(root.with({data, {}, "", "false"}));
+                ordered.insert(root.with({data, {}, "", "false"}));
+            }
+            CHECK(unordered.size() == 3);
+            CHECK(ordered.size() == 3);
+            CHECK(getValue(*ordered.begin()) == R"({1.000000, {}, "", 0})");
+        }
+    }
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <catch.hpp>
+
+#include "structure/Delta.hpp"
+#include "structure/value/SharedValue.hpp"
+#include "structure/value/BlockValue.hpp"
+#include "structure/value/GenericFieldValue.hpp"
+#include "structure/Exception.hpp"
+#include "structure/functions.hpp"
+#include "structure/type/stock.hpp"
+
+#include <limits>
+
+using namespace structure;
+
+SCENARIO("Value diff and patch", "[value][delta]")
+{
+    Block root("root", UInt8("a"), Block("b", Int32("c"), Double("d"), String("e")),
+               VarArray("f", Bool("g")), Double("h"));
+
+    GIVEN ("Two values of the same structure") {
+        auto before = root.with({"1", {"-2", "3.5", "egg"}, {"true", "false"}, "0.25"});
+        auto after = root.with({"1", {"-200000", "3.5", "spam"}, {"true", "true"}, "0.25"});
+
+        THEN ("Their diff should only list the changed fields") {
+            auto delta = diff(*before, *after);
+            REQUIRE(delta.getChanges().size() == 3);
+
+            CHECK(delta.getChanges()[0].field == 1);
+            CHECK(delta.getChanges()[0].before == Atom(-2));
+            CHECK(delta.getChanges()[0].after == Atom(-200000));
+            CHECK(delta.getChanges()[1].field == 3);
+            CHECK(delta.getChanges()[1].before == Atom("egg"));
+            CHECK(delta.getChanges()[1].after == Atom("spam"));
+            CHECK(delta.getChanges()[2].field == 5);
+            CHECK(delta.getChanges()[2].after == Atom(true));
+
+            CHECK(diff(*before, *before).empty());
+        }
+
+        THEN ("Patching the older value should produce the newer one") {
+            patch(*before, diff(*before, *after));
+            CHECK(*before == *after);
+        }
+
+        THEN ("The delta should survive an encoding round trip") {
+            auto delta = diff(*before, *after);
+            auto encoded = delta.encode();
+            // Fingerprint, count and changes: far smaller than the values themselves.
+            CHECK(encoded.size() == 8 + 1 + 7 + 12 + 3);
+
+            auto decoded = Delta::decode(encoded);
+            CHECK(decoded.getFingerprint() == delta.getFingerprint());
+            REQUIRE(decoded.getChanges().size() == delta.getChanges().size());
+            for (size_t i = 0; i < delta.getChanges().size(); ++i) {
+                CHECK(decoded.getChanges()[i].field == delta.getChanges()[i].field);
+                CHECK(decoded.getChanges()[i].before == delta.getChanges()[i].before);
+                CHECK(decoded.getChanges()[i].after == delta.getChanges()[i].after);
+            }
+
+            patch(*before, decoded);
+            CHECK(*before == *after);
+        }
+
+        THEN ("Malformed encoded deltas should be rejected") {
+            auto encoded = diff(*before, *after).encode();
+            encoded.pop_back();
+            CHECK_THROWS_AS(Delta::decode(encoded), ParseError &);
+            encoded.push_back(0x42);
+            encoded.push_back(0x42);
+            CHECK_THROWS_AS(Delta::decode(encoded), ParseError &);
+        }
+    }
+
+    GIVEN ("Floating point changes") {
+        THEN ("They should be encoded without loss") {
+            for (long double value : {1.5L, 0.1L, 1 / 3.0L, -1e300L * 1e300L,
+                                      std::numeric_limits<long double>::max(),
+                                      std::numeric_limits<long double>::denorm_min(),
+                                      std::numeric_limits<long double>::infinity()}) {
+                Delta delta(0);
+                delta.add(0, Atom(0.0L), Atom(value));
+                auto decoded = Delta::decode(delta.encode());
+                REQUIRE(decoded.getChanges().size() == 1);
+                CHECK(decoded.getChanges()[0].after == Atom(value));
+            }
+        }
+    }
+
+    GIVEN ("Values holding NaNs") {
+        Block floats("floats", Double("d"), Float("f"));
+        auto value = floats.with({"0", "-0"});
+        // NaNs can't be imported, they can only be set
+        auto &d = dynamic_cast<FieldValue<Double> &>(getChild(*value, "d"));
+        d.setTypedValue(std::numeric_limits<double>::quiet_NaN());
+
+        THEN ("Copies should not differ, as they are equal") {
+            auto copy = value->clone();
+            CHECK(*copy == *value);
+            CHECK(diff(*value, *copy).getChanges().empty());
+            CHECK(diff(*value, *floats.with({"0", "0"})).getChanges().size() == 1);
+        }
+    }
+
+    GIVEN ("Incompatible values") {
+        auto value = root.with({"1", {"-2", "3.5", "egg"}, {"true"}, "0.25"});
+
+        THEN ("Diffing values with different layouts should throw") {
+            auto longer = root.with({"1", {"-2", "3.5", "egg"}, {"true", "false"}, "0.25"});
+            CHECK_THROWS_AS(diff(*value, *longer), ValueStructureMismatch &);
+            CHECK_THROWS_AS(diff(*value, *Block("root").with({})), ValueStructureMismatch &);
+        }
+
+        THEN ("Patching a value of a different structure should throw") {
+            CHECK_THROWS_AS(patch(*value, Delta(0)), ValueStructureMismatch &);
+        }
+
+        THEN ("Patching an unexisting field should throw") {
+            Delta delta(root.getFingerprint());
+            delta.add(42, Atom(true), Atom(false));
+            CHECK_THROWS_AS(patch(*value, delta), ValueStructureMismatch &);
+        }
+
+        THEN ("Patching a field with an incompatible storage should throw") {
+            Delta delta(root.getFingerprint());
+            delta.add(0, Atom(1), Atom(256));
+            CHECK_THROWS_AS(patch(*value, delta), ParseError &);
+            delta = Delta(root.getFingerprint());
+            delta.add(0, Atom(1), Atom("1"));
+            CHECK_THROWS_AS(patch(*value, delta), ParseError &);
+        }
+    }
+
+    GIVEN ("Fields with restrictions") {
+        Block restricted("restricted", UInt8("a"), Int32("b", attributes::mkRange(-10, 10)),
+                         FixedString<8>("c", attributes::MaxLength{3}));
+        auto value = restricted.with({"1", "2", "abc"});
+        value->clearDirty();
+
+        THEN ("Patching them with disallowed storages should throw and leave the value as is") {
+            Delta outOfRange(restricted.getFingerprint());
+            outOfRange.add(0, Atom(1), Atom(5));
+            outOfRange.add(1, Atom(2), Atom(11));
+            CHECK_THROWS_AS(patch(*value, outOfRange), std::range_error &);
+
+            Delta tooLong(restricted.getFingerprint());
+            tooLong.add(0, Atom(1), Atom(5));
+            tooLong.add(2, Atom("abc"), Atom("abcd"));
+            CHECK_THROWS_AS(patch(*value, tooLong), std::range_error &);
+
+            CHECK(getValue(value) == R"({1, 2, "abc"})");
+            CHECK(not value->isDirty());
+        }
+    }
+}
+
+SCENARIO("Structurally shared values", "[value][delta][shared]")
+{
+    Block root("root", UInt8("a"), Block("b", Int32("c"), String("d")), Block("e", Bool("f")));
+    auto child = [](const SharedValue &value, size_t index) {
+        auto &block = dynamic_cast<const BlockValue &>(*value);
+        return std::next(block.getFields().begin(), index)->get();
+    };
+
+    GIVEN ("A shared value") {
+        SharedValue first = root.with({"1", {"-2", "egg"}, {"true"}});
+        REQUIRE(first->getFieldCount() == 4);
+
+        WHEN ("Patching one field") {
+            auto second = patch(first, 2, Atom("spam"));
+
+            THEN ("The original value should be left untouched") {
+                CHECK(*first == *root.with({"1", {"-2", "egg"}, {"true"}}));
+                CHECK(*second == *root.with({"1", {"-2", "spam"}, {"true"}}));
+            }
+
+            THEN ("Only the path to the field should be copied") {
+                CHECK(child(first, 0) == child(second, 0));
+                CHECK(child(first, 1) != child(second, 1));
+                CHECK(child(first, 2) == child(second, 2));
+                CHECK(diff(*first, *second).getChanges().size() == 1);
+            }
+
+            THEN ("Only the path to the field should be dirty") {
+                CHECK(second->isDirty());
+                CHECK(child(second, 1)->isDirty());
+                CHECK(not child(second, 2)->isDirty());
+                CHECK(not first->isDirty());
+            }
+
+            AND_WHEN ("Patching another field") {
+                Delta delta(root.getFingerprint());
+                delta.add(3, Atom(true), Atom(false));
+                auto third = patch(second, delta);
+
+                THEN ("Changes should accumulate") {
+                    CHECK(*third == *root.with({"1", {"-2", "spam"}, {"false"}}));
+                }
+                THEN ("Previous changes should not be dirty anymore") {
+                    CHECK(not child(third, 1)->isDirty());
+                    CHECK(child(third, 2)->isDirty());
+                    CHECK(child(second, 1)->isDirty());
+                }
+            }
+
+            THEN ("Shared subtrees should not be modifiable through any version") {
+                auto &shared = dynamic_cast<GenericFieldValue &>(*child(second, 0));
+                CHECK_THROWS_AS(shared.setStorage(Atom(3)), ImmutableValue &);
+                auto &block = dynamic_cast<BlockValue &>(*child(first, 2));
+                CHECK_THROWS_AS(block.addValue(Bool("g").with({"false"})), ImmutableValue &);
+                auto &nested = dynamic_cast<GenericFieldValue &>(*block.getFields().front());
+                CHECK_THROWS_AS(nested.setStorage(Atom(false)), ImmutableValue &);
+
+                CHECK(*second == *root.with({"1", {"-2", "spam"}, {"true"}}));
+                CHECK(not child(second, 2)->isDirty());
+            }
+
+            THEN ("Shared subtrees should outlive the value they were created in") {
+                first.reset();
+                auto &block = dynamic_cast<const BlockValue &>(*child(second, 2));
+                auto &shared = dynamic_cast<GenericFieldValue &>(*block.getFields().front());
+                CHECK_THROWS_AS(shared.setStorage(Atom(false)), ImmutableValue &);
+                CHECK(*second == *root.with({"1", {"-2", "spam"}, {"true"}}));
+            }
+        }
+
+        THEN ("Patching unexisting fields should throw") {
+            CHECK_THROWS_AS(patch(first, 4, Atom(1)), ValueStructureMismatch &);
+            CHECK_THROWS_AS(patch(first, Delta(0)), ValueStructureMismatch &);
+            CHECK_THROWS_AS(patch(first, 0, Atom(-1)), ParseError &);
+        }
+    }
+}
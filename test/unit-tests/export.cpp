@@ -89,5 +89,31 @@ TEST_CASE("Display", "[structure][value][display]")
 
         print(ss, value);
         CHECK(ss.str() == expected);
+
+        for (unsigned jobs : {1, 2, 5, 16}) {
+            std::stringstream parallel;
+            print(parallel, *value, jobs);
+            CHECK(parallel.str() == expected);
+        }
     }
 }
+
+TEST_CASE("Split", "[value][split]")
+{
+    Block root("root", Float("a"), Block("b", Int32("c"), Block("d", Int8("e"), Int8("f"))),
+               Int32("g"));
+    auto value = root.with({"1", {"2", {"3", "4"}}, "5"});
+
+    auto names = [](const std::vector<std::reference_wrapper<const StructureValue>> &chunks) {
+        std::string result;
+        for (const StructureValue &chunk : chunks) {
+            result += chunk.getName();
+        }
+        return result;
+    };
+
+    CHECK(names(split(*value, 1)) == "root");
+    CHECK(names(split(*value, 2)) == "abg");
+    CHECK(names(split(*value, 4)) == "acdg");
+    CHECK(names(split(*value, 100)) == "acefg");
+}
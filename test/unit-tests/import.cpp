@@ -27,14 +27,19 @@
 #include <catch.hpp>
 
 #include "structure/importer/StreamImporter.hpp"
+#include "structure/importer/BufferImporter.hpp"
 #include "structure/importer/PromptImporter.hpp"
 #include "structure/importer/MapImporter.hpp"
+#include "structure/importer/InstrumentedImporter.hpp"
+#include "structure/CsvImporter.hpp"
 
 #include "structure/functions.hpp"
 #include "structure/type/stock.hpp"
 
+#include <iomanip>
 #include <sstream>
 #include <map>
+#include <type_traits>
 
 using namespace structure;
 
@@ -64,6 +69,50 @@ SCENARIO("Importing values with ValueImporter subclasses", "[value][import]")
             }
         }
 
+        GIVEN ("A BufferImporter") {
+            THEN ("Creating a value from correct input should not throw.") {
+                std::string input = R"(1 2.3 4 "egg and spam" 5)";
+                auto importer = BufferImporter(input);
+                CHECK_NOTHROW(value = build(root, importer));
+                CHECK(getValue(value) == R"({1, {2.300000, 4}, "egg and spam", 5})");
+                CHECK(importer.getPosition() == input.size());
+            }
+            THEN ("Creating a value from erroneous input should throw.") {
+                std::string input = R"(1.2 3 4 "egg and spam" 5)";
+                auto importer = BufferImporter(input);
+                CHECK_THROWS(build(root, importer));
+            }
+            THEN ("Creating a value from partial input should throw.") {
+                auto importer = BufferImporter("1 2.3");
+                CHECK_THROWS_AS(build(root, importer), NotEnoughValues &);
+            }
+            THEN ("Temporary strings should be rejected, as they would not outlive the importer") {
+                CHECK((not std::is_constructible<BufferImporter, std::string &&>::value));
+                CHECK((std::is_constructible<BufferImporter, const std::string &>::value));
+            }
+            THEN ("Only the given size of the buffer should be read.") {
+                const char input[] = "1 2.3 4 spam 5 6";
+                auto importer = BufferImporter(input, 14);
+                CHECK_NOTHROW(value = build(root, importer));
+                CHECK(getValue(value) == R"({1, {2.300000, 4}, "spam", 5})");
+            }
+            THEN ("Quoted values should follow the rules of std::quoted.") {
+                auto input = std::string("\t\"a \\\"b\\\" \\\\\"\"\"c\n \"unterminated");
+                auto strings = VarArray("strings", String("s"));
+
+                auto importer = BufferImporter(input);
+                CHECK_NOTHROW(value = build(strings, importer));
+
+                std::stringstream stream(input);
+                for (const auto &expected : {R"(a "b" \)", "", "c", "unterminated"}) {
+                    std::string token;
+                    stream >> std::quoted(token);
+                    CHECK(token == expected);
+                }
+                CHECK(getValue(value) == R"({"a \"b\" \\", "", "c", "unterminated"})");
+            }
+        }
+
         GIVEN ("A PromptImporter") {
             auto importer = PromptImporter<>(ss, null, false);
             THEN ("Creating a value from correct input should not throw.") {
@@ -107,6 +156,57 @@ SCENARIO("Importing values with ValueImporter subclasses", "[value][import]")
                 CHECK_THROWS(build(root, importer));
             }
         }
+        GIVEN ("An InstrumentedImporter") {
+            auto input = StreamImporter<>(ss);
+            auto importer = InstrumentedImporter(input);
+            const auto &statistics = importer.getStatistics();
+            auto int8 = Int8("x").getTypeName();
+            auto floating = Float("x").getTypeName();
+
+            THEN ("It should count the values per field type and per block.") {
+                ss << R"(1 2.3 4 "egg and spam" 5)";
+                CHECK_NOTHROW(value = build(root, importer));
+                CHECK(getValue(value) == R"({1, {2.300000, 4}, "egg and spam", 5})");
+
+                CHECK(statistics.fieldTypes.size() == 3);
+                CHECK(statistics.fieldTypes.at(int8).values == 3);
+                CHECK(statistics.fieldTypes.at(floating).values == 1);
+                CHECK(statistics.total().values == 5);
+                CHECK(statistics.total().failures == 0);
+
+                CHECK(statistics.blockCount == 2);
+                CHECK(statistics.blocks.at("/root").values == 5);
+                CHECK(statistics.blocks.at("/root/b").values == 2);
+                CHECK(statistics.blocks.at("/root").time >= statistics.blocks.at("/root/b").time);
+            }
+            THEN ("It should count the failures and be resettable.") {
+                ss << "1 spam";
+                CHECK_THROWS(build(root, importer));
+                CHECK(statistics.fieldTypes.at(int8).values == 1);
+                CHECK(statistics.fieldTypes.at(floating).failures == 1);
+                CHECK(statistics.blocks.empty());
+
+                importer.reset();
+                CHECK(statistics.fieldTypes.empty());
+                CHECK(statistics.blockCount == 0);
+            }
+            THEN ("The end of a VarArray should neither be a failure nor leave blocks open.") {
+                auto items = Block("r", UInt8("x"), VarArray("v", Block("i", UInt8("a"))));
+                auto buffer = BufferImporter("1 2 3");
+                auto instrumented = InstrumentedImporter(buffer);
+                CHECK_NOTHROW(value = items.build(instrumented));
+                CHECK(getValue(value) == "{1, {{2}, {3}}}");
+
+                const auto &counted = instrumented.getStatistics();
+                auto uint8 = UInt8("x").getTypeName();
+                CHECK(counted.fieldTypes.at(uint8).values == 3);
+                CHECK(counted.fieldTypes.at(uint8).failures == 0);
+                CHECK(counted.blockCount == 4);
+                CHECK(counted.blocks.at("/r").values == 3);
+                CHECK(counted.blocks.at("/r/v").values == 2);
+                CHECK(counted.blocks.at("/r/v/i").values == 2);
+            }
+        }
         GIVEN ("A custom Importer") {
             THEN ("onEnterBlock and onExitBlock should be called for each block") {
                 struct CustomImporter : StreamImporter<>
@@ -138,5 +238,109 @@ SCENARIO("Importing values with ValueImporter subclasses", "[value][import]")
                 CHECK(getValue(value) == R"({1, {2.300000, 4}, "egg and spam", 5})");
             }
         }
+
+        GIVEN ("A value initializer") {
+            ValueInitializer initializer = {1, {2.3, "4"}, std::string("egg and spam"), 5u};
+            THEN ("It can be used several times") {
+                CHECK(getValue(root.with(initializer)) ==
+                      R"({1, {2.300000, 4}, "egg and spam", 5})");
+                CHECK(getValue(root.with(initializer)) ==
+                      R"({1, {2.300000, 4}, "egg and spam", 5})");
+            }
+            THEN ("Values must match the structure") {
+                CHECK_THROWS_AS(root.with({1, {2.3}, "", 5}), NotEnoughValues &);
+                CHECK_THROWS_AS(root.with({1, {2.3, 4, 5}, "", 5}), ValueStructureMismatch &);
+                CHECK_THROWS_AS(root.with({1, {2.3, 4}, "", 5, 6}), ValueStructureMismatch &);
+                CHECK_THROWS_AS(root.with({1, 2, "", 5}), ValueStructureMismatch &);
+                CHECK_THROWS_AS(root.with({{1}, {2.3, 4}, "", 5}), ValueImporter::WrongType &);
+            }
+            THEN ("Importers should see balanced block notifications") {
+                struct CountingImporter : StreamImporter<>
+                {
+                    int depth = 0;
+
+                    CountingImporter(std::istream &input) : StreamImporter<>(input) {}
+
+                    void onEnterBlock(const std::string &) override { depth++; }
+                    void onExitBlock(const std::string &) override { depth--; }
+                };
+
+                ss << "2.3 4";
+                CountingImporter importer(ss);
+                CHECK(getValue(root.with({"1", importer, "", "5"})) ==
+                      R"({1, {2.300000, 4}, "", 5})");
+                CHECK(importer.depth == 0);
+            }
+            THEN ("Variable-length arrays of blocks may be followed by other values") {
+                Block withArray("root", VarArray("v", Block("item", UInt8("x"))), UInt8("y"));
+                CHECK(getValue(withArray.with({{{"1"}, {"2"}}, "3"})) == "{{{1}, {2}}, 3}");
+            }
+        }
+    }
+}
+
+SCENARIO("Importing tables with a CsvImporter", "[value][import][csv]")
+{
+    GIVEN ("A row structure") {
+        Block row("row", UInt8("id"), Block("b", Float("c"), String("s")),
+                  Array("a", Int8("x"), 2), Int16("d", attributes::Default{-1}));
+
+        auto toStrings = [](const std::vector<std::unique_ptr<StructureValue>> &values) {
+            std::vector<std::string> result;
+            for (const auto &value : values) {
+                result.push_back(getValue(value));
+            }
+            return result;
+        };
+
+        THEN ("Columns should be mapped to leaves by their paths, in any order") {
+            auto values = CsvImporter(row).import("b/s,id,a/1/x,/row/a/0/x,b/c,d\r\n"
+                                                  "spam,1,-2,3,2.5,4\r\n"
+                                                  "\r\n"
+                                                  "egg,2,5,6,0.5,7");
+            CHECK((toStrings(values) == std::vector<std::string>{
+                       R"({1, {2.500000, "spam"}, {3, -2}, 4})",
+                       R"({2, {0.500000, "egg"}, {6, 5}, 7})"}));
+        }
+        THEN ("Leaves without a column should get their default value") {
+            auto values = CsvImporter(row, '\t').import("id\tb/c\tb/s\ta/0/x\ta/1/x\n"
+                                                        "1\t2\ts\t3\t4\n");
+            REQUIRE(values.size() == 1);
+            CHECK(getValue(values[0]) == R"({1, {2.000000, "s"}, {3, 4}, -1})");
+        }
+        THEN ("Quoted cells may contain delimiters, quotes and line breaks") {
+            auto values = CsvImporter(row).import("id,b/c,b/s,a/0/x,a/1/x\n"
+                                                  "1,2,\"a,\"\"b\"\"\nc\",3,\"4\"\n"
+                                                  "2,2,\"\",3,4\n");
+            CHECK((toStrings(values) == std::vector<std::string>{
+                       "{1, {2.000000, \"a,\\\"b\\\"\nc\"}, {3, 4}, -1}",
+                       R"({2, {2.000000, ""}, {3, 4}, -1})"}));
+        }
+        THEN ("Importing with several jobs should give the same values") {
+            std::string table = "id,b/c,b/s,a/0/x,a/1/x,d\n";
+            for (int i = 0; i < 100; ++i) {
+                auto cell = std::to_string(i);
+                table += cell + "," + cell + ",\"" + cell + "\"," + cell + ",-" + cell + ",7\n";
+            }
+            auto expected = toStrings(CsvImporter(row).import(table));
+            REQUIRE(expected.size() == 100);
+            CHECK(expected[42] == R"({42, {42.000000, "42"}, {42, -42}, 7})");
+            CHECK(toStrings(CsvImporter(row).import(table, 4)) == expected);
+        }
+        THEN ("Malformed tables should be rejected") {
+            CsvImporter importer(row);
+            CHECK_THROWS_AS(importer.import(""), CsvError &);
+            CHECK_THROWS_AS(importer.import("id,nope\n1,2\n"), ChildNotFound &);
+            CHECK_THROWS_AS(importer.import("id,/row/id\n1,2\n"), CsvError &);
+            CHECK_THROWS_AS(importer.import("id\n1,2\n"), CsvError &);
+            CHECK_THROWS_AS(importer.import("id\n\"1\n"), CsvError &);
+            CHECK_THROWS_AS(importer.import("id\n\"1\"2\n"), CsvError &);
+            CHECK_THROWS_AS(importer.import("id\n1\"\n"), CsvError &);
+            CHECK_THROWS(importer.import("id\nspam\n"));
+            CHECK_THROWS_AS(importer.import("b/c\n1\n"), NoDefaultValue &);
+        }
+        THEN ("Rows with a variable length should be rejected") {
+            CHECK_THROWS_AS(CsvImporter(Block("row", VarArray("v", UInt8("i")))), CsvError &);
+        }
     }
 }
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <catch.hpp>
+
+#include "structure/functions.hpp"
+#include "structure/type/stock.hpp"
+#include "PfwExport.hpp"
+#include "import.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace structure
+{
+namespace
+{
+std::unique_ptr<Block> import(const std::string &xml)
+{
+    return importStructure(xml.data(), xml.size());
+}
+
+/** A subsystem whose only instance is of the given component type */
+std::string subsystem(const std::string &library, const std::string &type = "Type")
+{
+    return "<Subsystem Name=\"System\"><ComponentLibrary>" + library +
+           "</ComponentLibrary><InstanceDefinition><Component Name=\"Instance\" Type=\"" +
+           type + "\"/></InstanceDefinition></Subsystem>";
+}
+} // namespace
+
+SCENARIO("Parameter Framework import", "[import][pfw]")
+{
+    GIVEN ("An exported structure") {
+        Block root("MyData", Block("Complex", Float("Real"), Float("Imaginary")),
+                   UInt32("Counter"), Q32f31("Fixed"), Array("Levels", Int16("level"), 3),
+                   Array("Points", Block("point", Double("x"), Double("y")), 2));
+
+        THEN ("Importing it should give back the same types") {
+            std::istringstream xml(pfw_export::exportStructure(root));
+            auto imported = importStructure(xml);
+            CHECK(imported->getName() == "Example");
+            const auto &data = getChild(*imported, "MyData");
+            CHECK(getChild(data, "Complex/Imaginary").getTraits().size == 32);
+            CHECK(getChild(data, "Counter").getTraits().kind == StructureKind::Integer);
+            CHECK(not getChild(data, "Counter").getTraits().isSigned);
+            CHECK(getChild(data, "Fixed").getTraits().fractional == 31);
+            CHECK(getChild(data, "Levels").getTraits().count == 3);
+            CHECK(getChild(data, "Points").getTraits().count == 2);
+            // Items are named after their array
+            CHECK(getChild(data, "Points/Points/y").getTraits().size == 64);
+
+            CHECK(pfw_export::exportStructure(data) == pfw_export::exportStructure(root));
+        }
+    }
+
+    GIVEN ("Component types extending and containing each other") {
+        auto imported = import(
+            "<?xml version=\"1.0\"?>\n"
+            "<!-- Comments, <![CDATA[sections]]> and text are skipped -->\n"
+            "<Subsystem Name='System'>\n"
+            "  <ComponentLibrary>\n"
+            "    <ComponentType Name='Base'><IntegerParameter Name='a' Size='8'/></ComponentType>\n"
+            "    <ComponentType Name='Derived' Extends='Base' Description='derived'>\n"
+            "      <Component Name='nested' Type='Base' ArrayLength='2'/>\n"
+            "      <IntegerParameter Name='b' Size='16' Signed='true' Min='-5' Max='5'>\n"
+            "        <BitParameterBlock Name='ignored'/>\n"
+            "      </IntegerParameter>\n"
+            "    </ComponentType>\n"
+            "  </ComponentLibrary>\n"
+            "  <InstanceDefinition>\n"
+            "    <Component Name='Instance' Type='Derived'/>\n"
+            "  </InstanceDefinition>\n"
+            "</Subsystem>");
+
+        THEN ("Instances should contain the inherited parameters first") {
+            const auto &instance = dynamic_cast<const Block &>(getChild(*imported, "Instance"));
+            CHECK(instance.getDescription() == "derived");
+            auto value = instance.with({"1", {{"2"}, {"3"}}, "-4"});
+            CHECK(getValue(value) == "{1, {{2}, {3}}, -4}");
+        }
+        THEN ("Ranges should be imported") {
+            const auto &instance = dynamic_cast<const Block &>(getChild(*imported, "Instance"));
+            CHECK_THROWS(instance.with({"1", {{"2"}, {"3"}}, "6"}));
+            CHECK_NOTHROW(instance.with({"1", {{"2"}, {"3"}}, "-5"}));
+        }
+    }
+
+    GIVEN ("A component library on its own") {
+        auto imported = import("<ComponentLibrary>"
+                               "<ComponentType Name='A'><FloatingPointParameter Name='f'/>"
+                               "</ComponentType>"
+                               "<ComponentType Name='B'><ParameterBlock Name='p'/></ComponentType>"
+                               "</ComponentLibrary>");
+
+        THEN ("It should be instantiated once per component type") {
+            CHECK(imported->getName() == "ComponentLibrary");
+            CHECK(getValue(imported->with({{"1.5"}, {{}}})) == "{{1.500000}, {{}}}");
+        }
+    }
+
+    GIVEN ("Attributes containing entities") {
+        auto imported = import(subsystem("<ComponentType Name='Type'>"
+                                         "<IntegerParameter Name='&lt;a&amp;b&gt;' Size='8' "
+                                         "Description='&quot;&apos;&#65;&#x42;&#xe9;&#x20ac;'/>"
+                                         "</ComponentType>"));
+
+        THEN ("They should be decoded") {
+            const auto &field = getChild(*imported, "Instance/<a&b>");
+            CHECK(field.getDescription() == "\"'AB\xc3\xa9\xe2\x82\xac");
+        }
+    }
+
+    GIVEN ("Malformed documents") {
+        THEN ("Importing them should throw") {
+            for (auto xml : {"", "<Subsystem Name='S'>", "<Subsystem Name='S'></Other>",
+                             "<Subsystem Name='S'/></Subsystem>", "<Subsystem Name='S></Subsystem>",
+                             "<Subsystem Name=S/>", "<Subsystem Name='S'", "<!-- unterminated",
+                             "<Subsystem Name='&unknown;'/>", "<Subsystem Name='&#xzz;'/>",
+                             "<Subsystem Name='&#x110000;'/>", "<Subsystem Name='&amp'/>",
+                             "<Subsystem/>", "<Other/>", "<Subsystem Name='S'><Other/></Subsystem>",
+                             "<ComponentLibrary><Other/></ComponentLibrary>"}) {
+                CAPTURE(xml);
+                CHECK_THROWS_AS(import(xml), std::runtime_error &);
+            }
+        }
+    }
+
+    GIVEN ("Invalid component types") {
+        THEN ("Importing them should throw") {
+            for (auto library : {
+                     // Recursive definitions
+                     "<ComponentType Name='Type'><Component Name='c' Type='Type'/></ComponentType>",
+                     "<ComponentType Name='Type' Extends='Other'/><ComponentType Name='Other'>"
+                     "<Component Name='c' Type='Type'/></ComponentType>",
+                     "<ComponentType Name='Type' Extends='Type'/>",
+                     // Unknown or duplicate types
+                     "<ComponentType Name='Other'/>",
+                     "<ComponentType Name='Type' Extends='Other'/>",
+                     "<ComponentType Name='Type'/><ComponentType Name='Type'/>",
+                     // Unsupported elements and attributes
+                     "<ComponentType Name='Type'><BitParameterBlock Name='b'/></ComponentType>",
+                     "<ComponentType Name='Type'><IntegerParameter Name='i'/></ComponentType>",
+                     "<ComponentType Name='Type'>"
+                     "<IntegerParameter Name='i' Size='12'/></ComponentType>",
+                     "<ComponentType Name='Type'>"
+                     "<IntegerParameter Name='i' Size='8' ArrayLength='-1'/></ComponentType>",
+                     "<ComponentType Name='Type'>"
+                     "<FloatingPointParameter Name='f' Size='16'/></ComponentType>"}) {
+                CAPTURE(library);
+                CHECK_THROWS_AS(import(subsystem(library)), std::runtime_error &);
+            }
+        }
+    }
+
+    GIVEN ("Fixed point parameters") {
+        auto fixed = [](const std::string &size, const std::string &integral,
+                        const std::string &fractional) {
+            return import(subsystem("<ComponentType Name='Type'><FixedPointParameter Name='q' "
+                                    "Size='" + size + "' Integral='" + integral +
+                                    "' Fractional='" + fractional + "'/></ComponentType>"));
+        };
+
+        THEN ("Consistent sizes should be imported") {
+            auto imported = fixed("16", "3", "12");
+            const auto &q = getChild(*imported, "Instance/q");
+            CHECK(q.getTraits().size == 16);
+            CHECK(q.getTraits().fractional == 12);
+        }
+        THEN ("Inconsistent sizes should be rejected, even when their sum wraps around") {
+            CHECK_THROWS_AS(fixed("16", "3", "3"), std::runtime_error &);
+            CHECK_THROWS_AS(fixed("12", "3", "8"), std::runtime_error &);
+            CHECK_THROWS_AS(fixed("32", "0", "40"), std::runtime_error &);
+            CHECK_THROWS_AS(fixed("32", "18446744073709551615", "32"), std::runtime_error &);
+            CHECK_THROWS_AS(fixed("32", "40", "18446744073709551607"), std::runtime_error &);
+        }
+    }
+}
+} // namespace structure
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <catch.hpp>
+
+#include "structure/type/stock.hpp"
+#include "PfwExport.hpp"
+
+#include <sstream>
+#include <string>
+
+namespace structure
+{
+SCENARIO("Parameter Framework export", "[export][pfw]")
+{
+    GIVEN ("A structure of supported types") {
+        Block root("MyData", Block("Complex", Float("Real"), Float("Imaginary")),
+                   UInt32("Counter"), Q32f31("Fixed"));
+
+        THEN ("It should be exported as a subsystem") {
+            std::string expected =
+                "<Subsystem xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+                "Name=\"Example\" Type=\"Virtual\">\n"
+                "<ComponentLibrary>\n\n"
+                "    <ComponentType Name=\"MyData\">\n"
+                "        <ParameterBlock Name=\"Complex\">\n"
+                "            <FloatingPointParameter Name=\"Real\" Size=\"32\"/>\n"
+                "            <FloatingPointParameter Name=\"Imaginary\" Size=\"32\"/>\n"
+                "        </ParameterBlock>\n"
+                "        <IntegerParameter Name=\"Counter\" Size=\"32\" Signed=\"false\"/>\n"
+                "        <FixedPointParameter Name=\"Fixed\" Size=\"32\" Integral=\"0\" "
+                "Fractional=\"31\"/>\n"
+                "    </ComponentType>\n\n"
+                "</ComponentLibrary>\n\n"
+                "<InstanceDefinition>\n"
+                "    <Component Name=\"MyData\" Type=\"MyData\"/>\n"
+                "</InstanceDefinition>\n"
+                "</Subsystem>";
+            CHECK(pfw_export::exportStructure(root) == expected);
+
+            AND_THEN ("Streaming it should give the same result") {
+                std::ostringstream out;
+                pfw_export::exportStructure(root, out);
+                CHECK(out.str() == expected);
+            }
+        }
+
+        THEN ("Its values should be exported as settings") {
+            auto value = root.with({{"1.5", "-2"}, "2", "0.5"});
+            std::string expected =
+                "<ParameterBlock Name=\"MyData\">\n"
+                "    <ParameterBlock Name=\"Complex\">\n"
+                "        <FloatingPointParameter Name=\"Real\" Size=\"32\">1.500000"
+                "</FloatingPointParameter>\n"
+                "        <FloatingPointParameter Name=\"Imaginary\" Size=\"32\">-2.000000"
+                "</FloatingPointParameter>\n"
+                "    </ParameterBlock>\n"
+                "    <IntegerParameter Name=\"Counter\" Size=\"32\" Signed=\"false\">2"
+                "</IntegerParameter>\n"
+                "    <FixedPointParameter Name=\"Fixed\" Size=\"32\" Integral=\"0\" "
+                "Fractional=\"31\">0.500000</FixedPointParameter>\n"
+                "</ParameterBlock>\n";
+            CHECK(pfw_export::exportValue(*value) == expected);
+        }
+    }
+
+    GIVEN ("A structure containing arrays") {
+        Block root("Arrays", Array("Levels", Int16("level"), 3),
+                   Array("Points", Block("point", Double("x"), Double("y")), 2));
+
+        THEN ("Arrays should be exported through their length") {
+            std::string expected =
+                "    <ComponentType Name=\"Arrays\">\n"
+                "        <IntegerParameter Name=\"Levels\" Size=\"16\" Signed=\"true\" "
+                "ArrayLength=\"3\"/>\n"
+                "        <ParameterBlock Name=\"Points\" ArrayLength=\"2\">\n"
+                "            <FloatingPointParameter Name=\"x\" Size=\"64\"/>\n"
+                "            <FloatingPointParameter Name=\"y\" Size=\"64\"/>\n"
+                "        </ParameterBlock>\n"
+                "    </ComponentType>\n";
+            CHECK(pfw_export::exportStructure(root).find(expected) != std::string::npos);
+        }
+
+        THEN ("Their values should be exported as lists or indexed blocks") {
+            auto value = root.with({{"1", "-2", "3"}, {{"0", "1"}, {"2", "3"}}});
+            std::string expected =
+                "<ParameterBlock Name=\"Arrays\">\n"
+                "    <IntegerParameter Name=\"Levels\" Size=\"16\" Signed=\"true\" "
+                "ArrayLength=\"3\">1 -2 3</IntegerParameter>\n"
+                "    <ParameterBlock Name=\"Points\">\n"
+                "        <ParameterBlock Name=\"0\">\n"
+                "            <FloatingPointParameter Name=\"x\" Size=\"64\">0.000000"
+                "</FloatingPointParameter>\n"
+                "            <FloatingPointParameter Name=\"y\" Size=\"64\">1.000000"
+                "</FloatingPointParameter>\n"
+                "        </ParameterBlock>\n"
+                "        <ParameterBlock Name=\"1\">\n"
+                "            <FloatingPointParameter Name=\"x\" Size=\"64\">2.000000"
+                "</FloatingPointParameter>\n"
+                "            <FloatingPointParameter Name=\"y\" Size=\"64\">3.000000"
+                "</FloatingPointParameter>\n"
+                "        </ParameterBlock>\n"
+                "    </ParameterBlock>\n"
+                "</ParameterBlock>\n";
+            CHECK(pfw_export::exportValue(*value) == expected);
+        }
+    }
+
+    GIVEN ("An array of Q numbers") {
+        Block root("Gains", Array("Gain", Q16f15("g"), 3));
+
+        THEN ("Their real values should be exported") {
+            auto value = root.with({{"-0.25", "0.75", "0"}});
+            CHECK(pfw_export::exportValue(*value).find(">-0.250000 0.750000 0.000000<") !=
+                  std::string::npos);
+        }
+    }
+
+    GIVEN ("Names containing XML special characters") {
+        Block root("<a&b>", Int8("\"quoted\""));
+
+        THEN ("They should be escaped") {
+            auto xml = pfw_export::exportStructure(root, "S&S");
+            CHECK(xml.find("Name=\"S&amp;S\"") != std::string::npos);
+            CHECK(xml.find("<ComponentType Name=\"&lt;a&amp;b&gt;\">") != std::string::npos);
+            CHECK(xml.find("<IntegerParameter Name=\"&quot;quoted&quot;\"") != std::string::npos);
+        }
+    }
+
+    GIVEN ("Unsupported types") {
+        THEN ("Exporting them should fail") {
+            CHECK_THROWS_AS(pfw_export::exportStructure(Block("b", UQ16f16("q"))),
+                            std::runtime_error &);
+            CHECK_THROWS_AS(pfw_export::exportStructure(Block("b", String("s"))),
+                            std::runtime_error &);
+            CHECK_THROWS_AS(pfw_export::exportStructure(Block("b", VarArray("v", UInt8("i")))),
+                            std::runtime_error &);
+            CHECK_THROWS_AS(pfw_export::exportStructure(UInt8("i")), std::runtime_error &);
+        }
+    }
+
+    GIVEN ("A writer with a tiny buffer") {
+        std::string result;
+        pfw_export::StringSink sink(result);
+        pfw_export::XmlWriter writer(sink, 4);
+
+        THEN ("Writes larger than the buffer should go through") {
+            writer.raw("ab");
+            writer.raw("0123456789");
+            writer.indent(20);
+            writer.escaped("<>");
+            writer.flush();
+            CHECK(result == "ab0123456789" + std::string(80, ' ') + "&lt;&gt;");
+        }
+    }
+}
+} // namespace structure
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2016, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Intel Corporation nor the names of its contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <catch.hpp>
+
+#include "structure/value/VersionedValue.hpp"
+#include "structure/value/BlockValue.hpp"
+#include "structure/value/FieldValue.hpp"
+#include "structure/Delta.hpp"
+#include "structure/functions.hpp"
+#include "structure/type/stock.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace structure;
+
+SCENARIO("Versioned values", "[value][versioned]")
+{
+    Block root("root", UInt32("a"), UInt32("b"), Block("c", String("d")));
+
+    GIVEN ("A versioned value") {
+        VersionedValue versioned(root.with({1, 1, {"spam"}}));
+        auto first = versioned.snapshot();
+        CHECK(versioned.getVersion() == 0);
+
+        THEN ("Updates should not alter existing snapshots") {
+            auto second = versioned.update(diff(*first, *root.with({2, 1, {"eggs"}})));
+            CHECK(versioned.getVersion() == 1);
+            CHECK(versioned.snapshot() == second);
+            CHECK(*first == *root.with({1, 1, {"spam"}}));
+            CHECK(*second == *root.with({2, 1, {"eggs"}}));
+
+            auto firstFields = dynamic_cast<const BlockValue &>(*first).getFields();
+            auto secondFields = dynamic_cast<const BlockValue &>(*second).getFields();
+            CHECK(firstFields.front() != secondFields.front());
+            CHECK(*std::next(firstFields.begin()) == *std::next(secondFields.begin()));
+
+            AND_THEN ("Only the modified fields should be dirty") {
+                CHECK(not first->isDirty());
+                std::vector<std::string> dirty;
+                applyDirty(*second, [](const BlockValue &) {}, [](const BlockValue &) {},
+                           [&](const GenericFieldValue &v) { dirty.push_back(v.getName()); });
+                CHECK(dirty == (std::vector<std::string>{"a", "d"}));
+            }
+        }
+
+        THEN ("Failed updates should not publish anything") {
+            auto fail = [](StructureValue &) { throw std::runtime_error("failed"); };
+            CHECK_THROWS_AS(versioned.update(fail), std::runtime_error &);
+            CHECK(versioned.getVersion() == 0);
+            CHECK(versioned.snapshot() == first);
+        }
+
+        THEN ("Whole values can be published") {
+            versioned.publish(root.with({3, 3, {"bacon"}}));
+            CHECK(*versioned.snapshot() == *root.with({3, 3, {"bacon"}}));
+            CHECK_THROWS_AS(versioned.publish(nullptr), std::invalid_argument &);
+        }
+
+        THEN ("Old versions should be destroyed by writers, once readers drop them") {
+            std::weak_ptr<const StructureValue> weak = first;
+            for (uint32_t i = 2; i < 10; ++i) {
+                versioned.publish(root.with({i, i, {"spam"}}));
+            }
+            first.reset();
+            CHECK(not weak.expired());
+            versioned.collect();
+            CHECK(weak.expired());
+        }
+
+        THEN ("Readers should always see consistent snapshots") {
+            // The writer keeps both fields equal: a reader seeing them differ would have observed
+            // a partial update.
+            std::atomic<bool> done{false};
+            std::atomic<size_t> inconsistent{0};
+            std::vector<std::thread> readers;
+            for (int i = 0; i < 4; ++i) {
+                readers.emplace_back([&] {
+                    while (not done) {
+                        auto snapshot = versioned.snapshot();
+                        auto &block = dynamic_cast<const BlockValue &>(*snapshot);
+                        auto field = [&](size_t index) {
+                            auto &value = *std::next(block.getFields().begin(), index)->get();
+                            return dynamic_cast<const FieldValue<UInt32> &>(value).getTypedValue();
+                        };
+                        if (field(0) != field(1)) {
+                            ++inconsistent;
+                        }
+                    }
+                });
+            }
+            for (uint32_t i = 2; i < 500; ++i) {
+                versioned.update([i](StructureValue &value) {
+                    auto field = dynamic_cast<BlockValue &>(value).getFields().begin();
+                    dynamic_cast<FieldValue<UInt32> &>(**field++).setTypedValue(i);
+                    dynamic_cast<FieldValue<UInt32> &>(**field).setTypedValue(i);
+                });
+            }
+            done = true;
+            for (auto &reader : readers) {
+                reader.join();
+            }
+            CHECK(inconsistent == 0);
+            CHECK(versioned.getVersion() == 498);
+        }
+    }
+}